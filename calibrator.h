@@ -1,113 +1,2700 @@
 #ifndef calibrator_h
 #define calibrator_h
 
-template <typename Numeric, typename = typename std::enable_if<std::is_arithmetic<Numeric>::value>::type>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <new>
+
+#if defined(__SSE2__) || defined(__AVX__)
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// Tables with up to this number of calibration points are searched by counting the breakpoints below the raw value instead of a binary search
+#ifndef CALIBRATOR_SMALL_TABLE
+#define CALIBRATOR_SMALL_TABLE 32
+#endif
+
+// Options of 'begin()'
+#define CALIBRATOR_INTEGRALS 0x01 // Precalculate the integrals of the segments, so that 'integrate()' and 'average()' take constant time
+#define CALIBRATOR_EXTREMA 0x02   // Precalculate a segment tree of the extrema of the segments, so that 'extrema()' takes logarithmic time
+
+// Number of samples that 'calibrateBlock()' checks at once for a common segment; all samples of such a run are calibrated without search
+#ifndef CALIBRATOR_RUN_LENGTH
+#define CALIBRATOR_RUN_LENGTH 16
+#endif
+
+// Largest number of calibration points that 'restore()' accepts by default; the number of points in the stored header is not covered by the CRC
+#ifndef CALIBRATOR_RESTORE_MAX_POINTS
+#define CALIBRATOR_RESTORE_MAX_POINTS 1024
+#endif
+
+// Identification of a binary calibration table ("CALT" in little endian byte order)
+#define CALIBRATOR_TABLE_MAGIC 0x544C4143UL
+#define CALIBRATOR_TABLE_VERSION 1
+
+// Flags of a binary calibration table
+#define CALIBRATOR_TABLE_COEFFICIENTS 0x01       // Coefficients of the interpolation are stored after the calibration points
+#define CALIBRATOR_TABLE_INTERPOLATION_SHIFT 4   // Bits 4 to 7 identify the interpolation of the coefficients (0 = linear, 1 = step, 2 = cubic)
+
+/**
+ * Header of a binary calibration table.
+ * The header is followed by the raw values, the calibration values and optionally the coefficients of the interpolation (e.g. the slopes and the y-intercepts), each as an array of 'numPoints' (or 'numPoints - 1') values in native byte order.
+ * The table can be memory-mapped or placed in flash and used by a calibrator without copying it.
+ */
+struct CalibratorTableHeader
+{
+    uint32_t magic;      // CALIBRATOR_TABLE_MAGIC
+    uint16_t version;    // CALIBRATOR_TABLE_VERSION
+    uint8_t numericType; // Size of the numeric type in bytes, bit 6 set for floating point, bit 7 set for signed types
+    uint8_t flags;       // CALIBRATOR_TABLE_xxx flags
+    uint32_t numPoints;  // Number of calibration points
+    uint32_t checksum;   // CRC-32 of the data following the header
+};
+
+/**
+ * Calculates the CRC-32 (IEEE 802.3) of a block of data.
+ *
+ * @param data Data to be checked.
+ * @param length Length of the data in bytes.
+ * @param crc CRC of the preceding data when calculating the checksum piece by piece. Default is 0
+ * @return The CRC-32 of the data.
+ */
+inline uint32_t calibratorCrc32(const uint8_t *data, uint32_t length, uint32_t crc = 0)
+{
+    crc = ~crc;
+    for (uint32_t i = 0; i < length; i++)
+    {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++)
+            crc = (crc >> 1) ^ (0xEDB88320UL & (0 - (crc & 1)));
+    }
+    return ~crc;
+}
+
+/**
+ * Counts the values of an array that are smaller than a given value without branches.
+ * Used to find the segment of a raw value in small tables. Specialized with SIMD compares for 'float' and 'double' where available (SSE2/AVX, NEON; 'double' with NEON on AArch64 only).
+ *
+ * @param values Array of values.
+ * @param count Number of values in the array.
+ * @param value Value to compare against.
+ * @return Number of values that are smaller than 'value'.
+ */
+template <typename Numeric>
+inline uint32_t calibratorCountLess(const Numeric *values, uint32_t count, Numeric value)
+{
+    uint32_t result = 0;
+    for (uint32_t i = 0; i < count; i++)
+        result += values[i] < value;
+    return result;
+}
+
+inline uint32_t calibratorCountLess(const float *values, uint32_t count, float value)
+{
+    uint32_t result = 0;
+    uint32_t i = 0;
+#if defined(__AVX__)
+    __m256 value8 = _mm256_set1_ps(value);
+    for (; i + 8 <= count; i += 8)
+        result += __builtin_popcount(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(values + i), value8, _CMP_LT_OQ)));
+#endif
+#if defined(__SSE2__)
+    __m128 value4 = _mm_set1_ps(value);
+    for (; i + 4 <= count; i += 4)
+        result += __builtin_popcount(_mm_movemask_ps(_mm_cmplt_ps(_mm_loadu_ps(values + i), value4)));
+#elif defined(__ARM_NEON)
+    float32x4_t value4 = vdupq_n_f32(value);
+    uint32x4_t sum = vdupq_n_u32(0);
+    for (; i + 4 <= count; i += 4)
+        sum = vsubq_u32(sum, vcltq_f32(vld1q_f32(values + i), value4)); // A true lane is all ones (-1)
+    uint32x2_t pair = vadd_u32(vget_low_u32(sum), vget_high_u32(sum));
+    result += vget_lane_u32(vpadd_u32(pair, pair), 0);
+#endif
+    return result + calibratorCountLess<float>(values + i, count - i, value);
+}
+
+inline uint32_t calibratorCountLess(const double *values, uint32_t count, double value)
+{
+    uint32_t result = 0;
+    uint32_t i = 0;
+#if defined(__AVX__)
+    __m256d value4 = _mm256_set1_pd(value);
+    for (; i + 4 <= count; i += 4)
+        result += __builtin_popcount(_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(values + i), value4, _CMP_LT_OQ)));
+#endif
+#if defined(__SSE2__)
+    __m128d value2 = _mm_set1_pd(value);
+    for (; i + 2 <= count; i += 2)
+        result += __builtin_popcount(_mm_movemask_pd(_mm_cmplt_pd(_mm_loadu_pd(values + i), value2)));
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    // Compares of 'double' lanes are only available on AArch64
+    float64x2_t value2 = vdupq_n_f64(value);
+    uint64x2_t sum = vdupq_n_u64(0);
+    for (; i + 2 <= count; i += 2)
+        sum = vsubq_u64(sum, vcltq_f64(vld1q_f64(values + i), value2)); // A true lane is all ones (-1)
+    result += static_cast<uint32_t>(vaddvq_u64(sum));
+#endif
+    return result + calibratorCountLess<double>(values + i, count - i, value);
+}
+
+/**
+ * Checks that there are at least two calibration points and that the raw values are sorted in ascending order.
+ * Shared by the calibrators, so that all of them accept the same tables.
+ *
+ * @param rawValues Array of raw values.
+ * @param numPoints Number of calibration points in the array.
+ * @return 'true' if the raw values are usable, otherwise 'false'.
+ */
+template <typename Numeric>
+inline bool calibratorCheckPoints(const Numeric *rawValues, uint32_t numPoints)
+{
+    // Check if there are at least two calibration points
+    if (numPoints <= 1)
+        return false;
+
+    // Check if rawValues array is sorted in ascending order
+    for (uint32_t i = 0; i < numPoints - 1; i++)
+    {
+        if (rawValues[i] > rawValues[i + 1])
+        {
+            // The rawValues array is not sorted in ascending order
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Callbacks to save and restore a calibrator to/from a byte storage (EEPROM, flash, file, ...).
+ *
+ * @param address Address of the first byte in the storage.
+ * @param data Bytes to write or buffer for the bytes read.
+ * @param length Number of bytes.
+ * @param context Pointer passed to 'save()' or 'restore()'.
+ * @return 'true' if successful, otherwise 'false'.
+ */
+typedef bool (*CalibratorWriteCallback)(uint32_t address, const uint8_t *data, uint32_t length, void *context);
+typedef bool (*CalibratorReadCallback)(uint32_t address, uint8_t *data, uint32_t length, void *context);
+
+/**
+ * Policies for raw values outside the calibration range, passed as second template parameter of the calibrator.
+ * 'below()' and 'above()' receive the value extrapolated with the first or last segment, the first or last calibration value and the flag passed to the constructor.
+ * Because the policy is known at compile time, the compiler removes the range checks that do not change the result.
+ */
+
+// Default: behaves like 'CalibratorClamp' if 'limitOutputToCalibrationRange' was set in the constructor, otherwise like 'CalibratorExtrapolate'
+struct CalibratorLimitFlag
+{
+    template <typename Numeric>
+    static Numeric below(Numeric extrapolated, Numeric tableValue, bool limitOutput) { return limitOutput ? tableValue : extrapolated; }
+    template <typename Numeric>
+    static Numeric above(Numeric extrapolated, Numeric tableValue, bool limitOutput) { return limitOutput ? tableValue : extrapolated; }
+};
+
+// The first or last calibration value is returned
+struct CalibratorClamp
+{
+    template <typename Numeric>
+    static Numeric below(Numeric, Numeric tableValue, bool) { return tableValue; }
+    template <typename Numeric>
+    static Numeric above(Numeric, Numeric tableValue, bool) { return tableValue; }
+};
+
+// The first or last segment is extended linearly
+struct CalibratorExtrapolate
+{
+    template <typename Numeric>
+    static Numeric below(Numeric extrapolated, Numeric, bool) { return extrapolated; }
+    template <typename Numeric>
+    static Numeric above(Numeric extrapolated, Numeric, bool) { return extrapolated; }
+};
+
+// A constant is returned below and above the range, e.g. 'CalibratorSaturate<0, 100>' or 'CalibratorSaturate<-1, -1>' as sentinel for integer types
+template <long Low, long High>
+struct CalibratorSaturate
+{
+    template <typename Numeric>
+    static Numeric below(Numeric, Numeric, bool) { return static_cast<Numeric>(Low); }
+    template <typename Numeric>
+    static Numeric above(Numeric, Numeric, bool) { return static_cast<Numeric>(High); }
+};
+
+// NaN is returned for raw values outside the range (floating point types only)
+struct CalibratorNaN
+{
+    template <typename Numeric>
+    static Numeric below(Numeric, Numeric, bool)
+    {
+        static_assert(std::numeric_limits<Numeric>::has_quiet_NaN, "CalibratorNaN requires a floating point type");
+        return std::numeric_limits<Numeric>::quiet_NaN();
+    }
+    template <typename Numeric>
+    static Numeric above(Numeric extrapolated, Numeric tableValue, bool limitOutput) { return below(extrapolated, tableValue, limitOutput); }
+};
+
+/**
+ * Search policies, passed as third template parameter of the calibrator.
+ * 'find()' returns the index of the first segment whose upper breakpoint is not smaller than the raw value (0 below, 'numPoints - 2' above the calibration range).
+ * A policy can precompute 'size()' values in 'prepare()', at most 'valuesPerPoint * numPoints + extraValues'.
+ */
+
+// Scans the breakpoints from the start, the cost grows with the segment index
+struct CalibratorLinearSearch
+{
+    static const uint32_t valuesPerPoint = 0;
+    static const uint32_t extraValues = 0;
+
+    static uint32_t size(uint32_t) { return 0; }
+
+    template <typename Numeric>
+    static bool prepare(const Numeric *, uint32_t, Numeric *) { return true; }
+
+    template <typename Numeric>
+    static uint32_t find(const Numeric *rawValues, uint32_t numPoints, const Numeric *, Numeric rawValue)
+    {
+        uint32_t i = 0;
+        while (i < numPoints - 2 && rawValues[i + 1] < rawValue)
+            i++;
+        return i;
+    }
+};
+
+// Binary search over the breakpoints
+struct CalibratorBinarySearch
+{
+    static const uint32_t valuesPerPoint = 0;
+    static const uint32_t extraValues = 0;
+
+    static uint32_t size(uint32_t) { return 0; }
+
+    template <typename Numeric>
+    static bool prepare(const Numeric *, uint32_t, Numeric *) { return true; }
+
+    template <typename Numeric>
+    static uint32_t find(const Numeric *rawValues, uint32_t numPoints, const Numeric *, Numeric rawValue)
+    {
+        // Binary search for the first upper breakpoint that is not smaller than the raw value
+        uint32_t low = 0;
+        uint32_t high = numPoints - 2;
+        while (low < high)
+        {
+            uint32_t mid = low + (high - low) / 2;
+            if (rawValues[mid + 1] < rawValue)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+        return low;
+    }
+};
+
+// Counts the inner breakpoints below the raw value without branches (see 'calibratorCountLess()'), best for small tables
+struct CalibratorCountSearch
+{
+    static const uint32_t valuesPerPoint = 0;
+    static const uint32_t extraValues = 0;
+
+    static uint32_t size(uint32_t) { return 0; }
+
+    template <typename Numeric>
+    static bool prepare(const Numeric *, uint32_t, Numeric *) { return true; }
+
+    template <typename Numeric>
+    static uint32_t find(const Numeric *rawValues, uint32_t numPoints, const Numeric *, Numeric rawValue)
+    {
+        return calibratorCountLess(rawValues + 1, numPoints - 2, rawValue);
+    }
+};
+
+// Default: 'CalibratorCountSearch' for tables with up to CALIBRATOR_SMALL_TABLE points, otherwise 'CalibratorBinarySearch'
+struct CalibratorAutoSearch
+{
+    static const uint32_t valuesPerPoint = 0;
+    static const uint32_t extraValues = 0;
+
+    static uint32_t size(uint32_t) { return 0; }
+
+    template <typename Numeric>
+    static bool prepare(const Numeric *, uint32_t, Numeric *) { return true; }
+
+    template <typename Numeric>
+    static uint32_t find(const Numeric *rawValues, uint32_t numPoints, const Numeric *searchData, Numeric rawValue)
+    {
+        if (numPoints <= CALIBRATOR_SMALL_TABLE)
+            return CalibratorCountSearch::find(rawValues, numPoints, searchData, rawValue);
+        return CalibratorBinarySearch::find(rawValues, numPoints, searchData, rawValue);
+    }
+};
+
+// Computes the segment from the distance to the first breakpoint, for (nearly) equally spaced breakpoints
+// 'begin()' fails if a breakpoint deviates by more than a quarter step from the uniform grid
+struct CalibratorUniformSearch
+{
+    static const uint32_t valuesPerPoint = 0;
+    static const uint32_t extraValues = 3;
+
+    static uint32_t size(uint32_t) { return 3; }
+
+    template <typename Numeric>
+    static bool prepare(const Numeric *rawValues, uint32_t numPoints, Numeric *searchData)
+    {
+        Numeric step = (rawValues[numPoints - 1] - rawValues[0]) / static_cast<Numeric>(numPoints - 1);
+        if (!(step > 0))
+            return false;
+
+        for (uint32_t i = 1; i < numPoints - 1; i++)
+        {
+            Numeric grid = rawValues[0] + static_cast<Numeric>(i) * step;
+            Numeric deviation = rawValues[i] > grid ? rawValues[i] - grid : grid - rawValues[i];
+            if (deviation > step / 4)
+                return false;
+        }
+
+        searchData[0] = rawValues[0];
+        searchData[1] = step;
+        searchData[2] = std::numeric_limits<Numeric>::is_integer ? 0 : Numeric(1) / step;
+        return true;
+    }
+
+    template <typename Numeric>
+    static uint32_t find(const Numeric *rawValues, uint32_t numPoints, const Numeric *searchData, Numeric rawValue)
+    {
+        if (!(rawValue > rawValues[0]))
+            return 0;
+        if (!(rawValue < rawValues[numPoints - 1]))
+            return numPoints - 2;
+
+        // Estimate the segment on the uniform grid and correct it by the deviation of the breakpoints
+        Numeric offset = rawValue - searchData[0];
+        uint32_t i = static_cast<uint32_t>(std::numeric_limits<Numeric>::is_integer ? offset / searchData[1] : offset * searchData[2]);
+        if (i > numPoints - 2)
+            i = numPoints - 2;
+        while (i < numPoints - 2 && rawValues[i + 1] < rawValue)
+            i++;
+        while (i > 0 && !(rawValues[i] < rawValue))
+            i--;
+        return i;
+    }
+};
+
+// Binary search over the breakpoints in Eytzinger (breadth-first) order, padded to a complete tree
+// The search always takes the same number of steps and the first levels share a few cache lines, best for large tables
+struct CalibratorEytzingerSearch
+{
+    static const uint32_t valuesPerPoint = 2;
+    static const uint32_t extraValues = 0;
+
+    static uint32_t size(uint32_t numPoints) { return treeSize(numPoints - 2); }
+
+    template <typename Numeric>
+    static bool prepare(const Numeric *rawValues, uint32_t numPoints, Numeric *searchData)
+    {
+        searchData[0] = 0; // The root is at index 1
+        fill(rawValues + 1, numPoints - 2, searchData, treeSize(numPoints - 2), 1, 0);
+        return true;
+    }
+
+    template <typename Numeric>
+    static uint32_t find(const Numeric *, uint32_t numPoints, const Numeric *searchData, Numeric rawValue)
+    {
+        // After descending the complete tree, the leaf position is the number of breakpoints below the raw value
+        uint32_t count = numPoints - 2;
+        uint32_t size = treeSize(count);
+        uint32_t node = 1;
+        while (node < size)
+            node = 2 * node + (searchData[node] < rawValue);
+        uint32_t i = node - size;
+        return i < count ? i : count;
+    }
+
+private:
+    // Smallest power of two that is greater than the number of inner breakpoints
+    static uint32_t treeSize(uint32_t count)
+    {
+        return count == 0 ? 1 : 1UL << (32 - __builtin_clz(count));
+    }
+
+    // Fills the tree in order, the unused nodes get the largest value of the type
+    template <typename Numeric>
+    static uint32_t fill(const Numeric *values, uint32_t count, Numeric *tree, uint32_t size, uint32_t node, uint32_t next)
+    {
+        if (node >= size)
+            return next;
+        next = fill(values, count, tree, size, 2 * node, next);
+        tree[node] = next < count ? values[next] : std::numeric_limits<Numeric>::max();
+        return fill(values, count, tree, size, 2 * node + 1, next + 1);
+    }
+};
+
+// Branchless binary search over the breakpoints padded to a power of two, for use in interrupts and other code with a worst-case execution time budget
+// Every call takes exactly 'steps(numPoints)' compare-and-add steps, independent of the raw value. Together with the interpolation and the two range
+// compares of 'calibrate()' the cost per call is constant for a given table length
+struct CalibratorFixedDepthSearch
+{
+    static const uint32_t valuesPerPoint = 2;
+    static const uint32_t extraValues = 0;
+
+    static uint32_t size(uint32_t numPoints) { return paddedSize(numPoints - 2); }
+
+    /**
+     * Returns the number of compare-and-add steps of every search in a table with the given number of calibration points.
+     */
+    static uint32_t steps(uint32_t numPoints)
+    {
+        return 32 - __builtin_clz(paddedSize(numPoints - 2));
+    }
+
+    template <typename Numeric>
+    static bool prepare(const Numeric *rawValues, uint32_t numPoints, Numeric *searchData)
+    {
+        // Inner breakpoints followed by the largest value of the type
+        uint32_t count = numPoints - 2;
+        uint32_t size = paddedSize(count);
+        for (uint32_t i = 0; i < size; i++)
+            searchData[i] = i < count ? rawValues[i + 1] : std::numeric_limits<Numeric>::max();
+        return true;
+    }
+
+    template <typename Numeric>
+    static uint32_t find(const Numeric *, uint32_t numPoints, const Numeric *searchData, Numeric rawValue)
+    {
+        // Count the breakpoints below the raw value, halving the step each time without branches
+        uint32_t count = numPoints - 2;
+        uint32_t size = paddedSize(count);
+        uint32_t i = 0;
+        for (uint32_t step = size / 2; step > 0; step /= 2)
+            i += step * (searchData[i + step - 1] < rawValue);
+        i += searchData[i] < rawValue;
+        return i < count ? i : count;
+    }
+
+private:
+    // Smallest power of two that is greater than the number of inner breakpoints
+    static uint32_t paddedSize(uint32_t count)
+    {
+        return count == 0 ? 1 : 1UL << (32 - __builtin_clz(count));
+    }
+};
+
+/**
+ * Interpolation policies, passed as fourth template parameter of the calibrator.
+ * A policy stores 'coefficients' values per segment. Coefficient k of segment i is stored at 'c[k * segments + i]', so every coefficient forms its own array.
+ * 'id' identifies the coefficients in a binary calibration table.
+ */
+
+// Piecewise constant: the calibration value of the lower breakpoint of the segment
+struct CalibratorStep
+{
+    static const uint8_t id = 1;
+    static const uint32_t coefficients = 1;
+    static const bool affine = true; // 'm * x + b' within a segment (m = 0), see 'sum()'
+
+    template <typename Numeric>
+    static void prepare(const Numeric *, const Numeric *calibrationValues, uint32_t numPoints, Numeric *c)
+    {
+        for (uint32_t i = 0; i < numPoints - 1; i++)
+            c[i] = calibrationValues[i];
+    }
+
+    template <typename Numeric>
+    static Numeric evaluate(const Numeric *, const Numeric *c, uint32_t, uint32_t i, Numeric)
+    {
+        return c[i];
+    }
+
+    // Sum of the interpolated values of 'count' raw values of segment i, whose sum is 'rawSum'
+    template <typename Numeric, typename Sum>
+    static Sum sum(const Numeric *, const Numeric *c, uint32_t, uint32_t i, Sum, uint32_t count)
+    {
+        return c[i] * static_cast<Sum>(count);
+    }
+
+    // Integral of segment i from raw value 'from' to 'to'
+    template <typename Numeric>
+    static Numeric integrate(const Numeric *, const Numeric *c, uint32_t, uint32_t i, Numeric from, Numeric to)
+    {
+        return c[i] * (to - from);
+    }
+
+    // Smallest and largest value of segment i between raw value 'from' and 'to'
+    template <typename Numeric>
+    static void extrema(const Numeric *, const Numeric *c, uint32_t, uint32_t i, Numeric, Numeric, Numeric &low, Numeric &high)
+    {
+        low = c[i];
+        high = c[i];
+    }
+};
+
+// Default: linear interpolation with slope (m) and y-intercept (b) per segment
+struct CalibratorLinear
+{
+    static const uint8_t id = 0;
+    static const uint32_t coefficients = 2;
+    static const bool affine = true; // 'm * x + b' within a segment, see 'sum()'
+
+    template <typename Numeric>
+    static void prepare(const Numeric *rawValues, const Numeric *calibrationValues, uint32_t numPoints, Numeric *c)
+    {
+        Numeric *m = c;
+        Numeric *b = c + (numPoints - 1);
+        for (uint32_t i = 0; i < numPoints - 1; i++)
+        {
+            m[i] = (calibrationValues[i + 1] - calibrationValues[i]) / (rawValues[i + 1] - rawValues[i]);
+            b[i] = calibrationValues[i] - m[i] * rawValues[i];
+        }
+    }
+
+    template <typename Numeric>
+    static Numeric evaluate(const Numeric *, const Numeric *c, uint32_t segments, uint32_t i, Numeric rawValue)
+    {
+        return c[i] * rawValue + c[segments + i];
+    }
+
+    // Sum of the interpolated values of 'count' raw values of segment i, whose sum is 'rawSum'
+    template <typename Numeric, typename Sum>
+    static Sum sum(const Numeric *, const Numeric *c, uint32_t segments, uint32_t i, Sum rawSum, uint32_t count)
+    {
+        return c[i] * rawSum + c[segments + i] * static_cast<Sum>(count);
+    }
+
+    // Integral of segment i from raw value 'from' to 'to'
+    template <typename Numeric>
+    static Numeric integrate(const Numeric *, const Numeric *c, uint32_t segments, uint32_t i, Numeric from, Numeric to)
+    {
+        return (to - from) * (c[i] * (from + to) / 2 + c[segments + i]);
+    }
+
+    // Smallest and largest value of segment i between raw value 'from' and 'to'
+    template <typename Numeric>
+    static void extrema(const Numeric *rawValues, const Numeric *c, uint32_t segments, uint32_t i, Numeric from, Numeric to, Numeric &low, Numeric &high)
+    {
+        low = evaluate(rawValues, c, segments, i, from);
+        high = evaluate(rawValues, c, segments, i, to);
+        if (high < low)
+        {
+            Numeric value = low;
+            low = high;
+            high = value;
+        }
+    }
+};
+
+// Monotone cubic Hermite interpolation (Fritsch-Carlson), the curve does not overshoot between the calibration points
+// Intended for floating point types
+struct CalibratorCubic
+{
+    static const uint8_t id = 2;
+    static const uint32_t coefficients = 4;
+    static const bool affine = false;
+
+    template <typename Numeric>
+    static void prepare(const Numeric *rawValues, const Numeric *calibrationValues, uint32_t numPoints, Numeric *c)
+    {
+        uint32_t segments = numPoints - 1;
+        Numeric tangent = slope(rawValues, calibrationValues, numPoints, 0);
+        for (uint32_t i = 0; i < segments; i++)
+        {
+            Numeric h = rawValues[i + 1] - rawValues[i];
+            Numeric secant = (calibrationValues[i + 1] - calibrationValues[i]) / h;
+            Numeric nextTangent = slope(rawValues, calibrationValues, numPoints, i + 1);
+
+            // Polynomial in the distance to the lower breakpoint: a + t * (b + t * (c + t * d))
+            c[i] = calibrationValues[i];
+            c[segments + i] = tangent;
+            c[2 * segments + i] = (3 * secant - 2 * tangent - nextTangent) / h;
+            c[3 * segments + i] = (tangent + nextTangent - 2 * secant) / (h * h);
+            tangent = nextTangent;
+        }
+    }
+
+    template <typename Numeric>
+    static Numeric evaluate(const Numeric *rawValues, const Numeric *c, uint32_t segments, uint32_t i, Numeric rawValue)
+    {
+        Numeric t = rawValue - rawValues[i];
+        return c[i] + t * (c[segments + i] + t * (c[2 * segments + i] + t * c[3 * segments + i]));
+    }
+
+    // Integral of segment i from raw value 'from' to 'to'
+    template <typename Numeric>
+    static Numeric integrate(const Numeric *rawValues, const Numeric *c, uint32_t segments, uint32_t i, Numeric from, Numeric to)
+    {
+        return antiderivative(rawValues, c, segments, i, to) - antiderivative(rawValues, c, segments, i, from);
+    }
+
+    // Smallest and largest value of segment i between raw value 'from' and 'to'
+    // Within the calibration range the curve is monotone per segment, but the extrapolated polynomial may turn, so the zeros of the derivative are checked as well
+    template <typename Numeric>
+    static void extrema(const Numeric *rawValues, const Numeric *c, uint32_t segments, uint32_t i, Numeric from, Numeric to, Numeric &low, Numeric &high)
+    {
+        Numeric values[4] = {evaluate(rawValues, c, segments, i, from), evaluate(rawValues, c, segments, i, to)};
+        uint8_t count = 2;
+
+        // Roots of the derivative b + 2c t + 3d t^2
+        Numeric b = c[segments + i];
+        Numeric cc = c[2 * segments + i];
+        Numeric d = c[3 * segments + i];
+        Numeric roots[2];
+        uint8_t numRoots = 0;
+        if (d == 0)
+        {
+            if (cc != 0)
+                roots[numRoots++] = -b / (2 * cc);
+        }
+        else
+        {
+            Numeric discriminant = cc * cc - 3 * d * b;
+            if (discriminant >= 0)
+            {
+                Numeric root = static_cast<Numeric>(sqrt(static_cast<double>(discriminant)));
+                roots[numRoots++] = (-cc - root) / (3 * d);
+                roots[numRoots++] = (-cc + root) / (3 * d);
+            }
+        }
+        for (uint8_t k = 0; k < numRoots; k++)
+        {
+            Numeric rawValue = rawValues[i] + roots[k];
+            if (from < rawValue && rawValue < to)
+                values[count++] = evaluate(rawValues, c, segments, i, rawValue);
+        }
+
+        low = values[0];
+        high = values[0];
+        for (uint8_t k = 1; k < count; k++)
+        {
+            if (values[k] < low)
+                low = values[k];
+            if (values[k] > high)
+                high = values[k];
+        }
+    }
+
+private:
+    // Antiderivative of the polynomial of segment i, zero at the lower breakpoint
+    template <typename Numeric>
+    static Numeric antiderivative(const Numeric *rawValues, const Numeric *c, uint32_t segments, uint32_t i, Numeric rawValue)
+    {
+        Numeric t = rawValue - rawValues[i];
+        return t * (c[i] + t * (c[segments + i] / 2 + t * (c[2 * segments + i] / 3 + t * c[3 * segments + i] / 4)));
+    }
+
+    // Tangent at a calibration point, zero at local extrema so that the curve stays monotone
+    template <typename Numeric>
+    static Numeric slope(const Numeric *rawValues, const Numeric *calibrationValues, uint32_t numPoints, uint32_t i)
+    {
+        if (i == 0 || i == numPoints - 1)
+        {
+            uint32_t j = i == 0 ? 0 : i - 1;
+            return (calibrationValues[j + 1] - calibrationValues[j]) / (rawValues[j + 1] - rawValues[j]);
+        }
+
+        Numeric h0 = rawValues[i] - rawValues[i - 1];
+        Numeric h1 = rawValues[i + 1] - rawValues[i];
+        Numeric s0 = (calibrationValues[i] - calibrationValues[i - 1]) / h0;
+        Numeric s1 = (calibrationValues[i + 1] - calibrationValues[i]) / h1;
+        if (s0 * s1 <= 0)
+            return 0;
+        return 3 * (h0 + h1) / ((2 * h1 + h0) / s0 + (h1 + 2 * h0) / s1);
+    }
+};
+
+/**
+ * Storage policies, passed as fifth template parameter of the calibrator.
+ * The storage provides the memory for the coefficients and the search data calculated by 'begin()'.
+ */
+
+// Default: the memory is allocated on the heap by 'begin()'
+struct CalibratorHeapStorage
+{
+    template <typename Numeric, uint32_t ValuesPerPoint, uint32_t ExtraValues>
+    class Buffer
+    {
+    public:
+        Buffer() : _data(nullptr), _capacity(0) {}
+        ~Buffer() { delete[] _data; }
+        Buffer(const Buffer &) = delete;
+        Buffer &operator=(const Buffer &) = delete;
+
+        Buffer(Buffer &&other) : _data(other._data), _capacity(other._capacity)
+        {
+            other._data = nullptr;
+            other._capacity = 0;
+        }
+
+        Buffer &operator=(Buffer &&other)
+        {
+            if (this != &other)
+            {
+                delete[] _data;
+                _data = other._data;
+                _capacity = other._capacity;
+                other._data = nullptr;
+                other._capacity = 0;
+            }
+            return *this;
+        }
+
+        // The memory is taken over when the buffer is moved, so pointers into it stay valid
+        const Numeric *relocate(const Numeric *pointer, const Buffer &) const { return pointer; }
+
+        // The memory is kept if it is large enough, so a repeated 'begin()' (e.g. by 'CalibratorFamily') does not allocate
+        Numeric *allocate(uint32_t count)
+        {
+            if (count > _capacity || _data == nullptr)
+            {
+                delete[] _data;
+                _data = new Numeric[count];
+                _capacity = count;
+            }
+            return _data;
+        }
+
+        void release()
+        {
+            delete[] _data;
+            _data = nullptr;
+            _capacity = 0;
+        }
+
+    private:
+        Numeric *_data;
+        uint32_t _capacity;
+    };
+};
+
+// The memory is part of the calibrator object, for tables with up to 'MaxPoints' calibration points and no heap
+// 'OptionValuesPerPoint' reserves memory for the options of 'begin()': 1 for 'CALIBRATOR_INTEGRALS', 4 for 'CALIBRATOR_EXTREMA'
+template <uint32_t MaxPoints, uint32_t OptionValuesPerPoint = 0>
+struct CalibratorInlineStorage
+{
+    template <typename Numeric, uint32_t ValuesPerPoint, uint32_t ExtraValues>
+    class Buffer
+    {
+    public:
+        Numeric *allocate(uint32_t count) { return count <= sizeof(_data) / sizeof(Numeric) ? _data : nullptr; }
+        void release() {}
+
+        // The values are copied when the buffer is moved, so pointers into the other buffer point to the same place in this one
+        const Numeric *relocate(const Numeric *pointer, const Buffer &from) const
+        {
+            uintptr_t address = reinterpret_cast<uintptr_t>(pointer);
+            uintptr_t first = reinterpret_cast<uintptr_t>(from._data);
+            if (address < first || address >= first + sizeof(_data))
+                return pointer;
+            return _data + (pointer - from._data);
+        }
+
+    private:
+        Numeric _data[MaxPoints * (ValuesPerPoint + OptionValuesPerPoint) + ExtraValues];
+    };
+};
+
+// The memory is provided by the application with 'storage().assign()' before 'begin()', use 'storageSize()' for the required number of values
+struct CalibratorExternalStorage
+{
+    template <typename Numeric, uint32_t ValuesPerPoint, uint32_t ExtraValues>
+    class Buffer
+    {
+    public:
+        Buffer() : _data(nullptr), _capacity(0) {}
+
+        void assign(Numeric *data, uint32_t capacity)
+        {
+            _data = data;
+            _capacity = capacity;
+        }
+
+        Numeric *allocate(uint32_t count) { return count <= _capacity ? _data : nullptr; }
+        void release() {}
+
+        // The buffer of the application is shared when the buffer is moved
+        const Numeric *relocate(const Numeric *pointer, const Buffer &) const { return pointer; }
+
+    private:
+        Numeric *_data;
+        uint32_t _capacity;
+    };
+};
+
+template <typename Numeric, typename OutOfRange = CalibratorLimitFlag, typename Search = CalibratorAutoSearch, typename Interpolation = CalibratorLinear, typename Storage = CalibratorHeapStorage,
+          typename = typename std::enable_if<std::numeric_limits<Numeric>::is_specialized>::type>
 class Calibrator
 {
 public:
+    // Numeric type of the calibration values
+    typedef Numeric NumericType;
+
+    // Type of sums of values, e.g. for 'calibrateMean()'; 64 bit for integer types so that large blocks do not overflow
+    typedef typename std::conditional<std::numeric_limits<Numeric>::is_integer, int64_t, Numeric>::type Sum;
+
+    // Memory for the coefficients and the search data
+    typedef typename Storage::template Buffer<Numeric, Interpolation::coefficients + Search::valuesPerPoint, Search::extraValues> StorageBuffer;
+
+    /**
+     * Constructor for the calibrator
+     *
+     * @param rawValues Array of raw values to calibrate.
+     * @param calibrationValues Array of calibrated values that match the raw values.
+     * @param numPoints Number of calibration points in the array.
+     * @param limitOutputToCalibrationRange An optional boolean variable that indicates whether to constrain the calibrated values to the range of the calibration table. Default is 'false'. Only used by the default policy 'CalibratorLimitFlag'
+     */
+    Calibrator(const Numeric *rawValues, const Numeric *calibrationValues, uint32_t numPoints, bool limitOutputToCalibrationRange = false)
+    {
+        // Pass the references of the input data
+        _rawValues = rawValues;
+        _calibrationValues = calibrationValues;
+        _limitOutput = limitOutputToCalibrationRange;
+        _numPoints = numPoints;
+        _coefficients = nullptr;
+        _searchData = nullptr;
+        _integrals = nullptr;
+        _extrema = nullptr;
+        _points = nullptr;
+    }
+
+    /**
+     * Constructor for a calibrator whose calibration table is loaded later with 'loadTable()'
+     */
+    Calibrator()
+        : Calibrator(nullptr, nullptr, 0)
+    {
+    }
+
+    ~Calibrator()
+    {
+        delete[] _points;
+    }
+
+    // The calibrator owns its coefficients and therefore cannot be copied
+    Calibrator(const Calibrator &) = delete;
+    Calibrator &operator=(const Calibrator &) = delete;
+
+    /**
+     * Move constructor, e.g. for arrays of calibrators or to return a calibrator from a function.
+     * The coefficients and a restored or composed table are taken over; the other calibrator is left without a calibration table.
+     */
+    Calibrator(Calibrator &&other)
+        : _storage(std::move(other._storage))
+    {
+        _points = nullptr;
+        take(other);
+    }
+
+    Calibrator &operator=(Calibrator &&other)
+    {
+        if (this != &other)
+        {
+            delete[] _points;
+            _points = nullptr;
+            _storage = std::move(other._storage);
+            take(other);
+        }
+        return *this;
+    }
+
+    /**
+     * This method checks that the data passed is usable and creates a calibration curve
+     *
+     * @param options Optional additional data to precalculate, e.g. 'CALIBRATOR_INTEGRALS'. Default is 0
+     * @return 'true' if successful, otherwise 'false'.
+     */
+    bool begin(uint8_t options = 0)
+    {
+        if (!calibratorCheckPoints(_rawValues, _numPoints))
+            return false;
+
+        // Generate arrays for the coefficients and the search data
+        _coefficients = nullptr;
+        _searchData = nullptr;
+        _integrals = nullptr;
+        _extrema = nullptr;
+        Numeric *data = _storage.allocate(storageSize(options));
+        if (data == nullptr)
+            return false;
+
+        // Calculate calibration curve
+        uint32_t count = coefficientCount(_numPoints);
+        Interpolation::prepare(_rawValues, _calibrationValues, _numPoints, data);
+        if (!Search::prepare(_rawValues, _numPoints, data + count))
+            return false;
+
+        _coefficients = data;
+        _searchData = data + count;
+
+        // Optional data behind the search data
+        Numeric *optional = data + count + Search::size(_numPoints);
+        uint32_t segments = _numPoints - 1;
+
+        // Integrals from the first calibration point up to each calibration point
+        if (options & CALIBRATOR_INTEGRALS)
+        {
+            optional[0] = 0;
+            for (uint32_t i = 0; i < segments; i++)
+                optional[i + 1] = optional[i] + Interpolation::integrate(_rawValues, _coefficients, segments, i, _rawValues[i], _rawValues[i + 1]);
+            _integrals = optional;
+            optional += _numPoints;
+        }
+
+        // Segment tree: minima in the first, maxima in the second 2 * segments values, leaves from index 'segments'
+        if (options & CALIBRATOR_EXTREMA)
+        {
+            Numeric *minima = optional;
+            Numeric *maxima = optional + 2 * segments;
+            for (uint32_t i = 0; i < segments; i++)
+                Interpolation::extrema(_rawValues, _coefficients, segments, i, _rawValues[i], _rawValues[i + 1], minima[segments + i], maxima[segments + i]);
+            for (uint32_t k = segments - 1; k > 0; k--)
+            {
+                minima[k] = minima[2 * k + 1] < minima[2 * k] ? minima[2 * k + 1] : minima[2 * k];
+                maxima[k] = maxima[2 * k + 1] > maxima[2 * k] ? maxima[2 * k + 1] : maxima[2 * k];
+            }
+            _extrema = optional;
+        }
+        return true;
+    }
+
+    /**
+     * This method uses a binary calibration table (see 'CalibratorTableHeader') in place, e.g. a memory-mapped file or a table in flash.
+     * If the table contains the coefficients, neither the table is copied nor the calibration curve is recalculated.
+     * The table must stay valid and unchanged as long as the calibrator uses it.
+     * If the table is not usable, the calibrator is left without a calibration table and 'calibrate()' returns the raw values.
+     *
+     * @param table Pointer to the table. Must be aligned for the numeric type.
+     * @param length Length of the table in bytes.
+     * @param verifyChecksum Optional boolean to skip the CRC check of the table data. Default is 'true'
+     * @return 'true' if successful, otherwise 'false'.
+     */
+    bool loadTable(const void *table, uint32_t length, bool verifyChecksum = true)
+    {
+        const CalibratorTableHeader *header = static_cast<const CalibratorTableHeader *>(table);
+
+        // The previous table is released even if the new one is not usable
+        clearTable();
+        delete[] _points;
+        _points = nullptr;
+
+        // Check the header
+        if (length < sizeof(CalibratorTableHeader) || reinterpret_cast<uintptr_t>(table) % alignof(Numeric) != 0)
+            return false;
+        if (!checkHeader(*header) || length != tableSize(header->numPoints, header->flags & CALIBRATOR_TABLE_COEFFICIENTS))
+            return false;
+
+        const uint8_t *data = static_cast<const uint8_t *>(table) + sizeof(CalibratorTableHeader);
+        if (verifyChecksum && calibratorCrc32(data, length - sizeof(CalibratorTableHeader)) != header->checksum)
+            return false;
+
+        // Point to the arrays of the table
+        const Numeric *values = reinterpret_cast<const Numeric *>(data);
+        _numPoints = header->numPoints;
+        _rawValues = values;
+        _calibrationValues = values + _numPoints;
+
+        bool ready = header->flags & CALIBRATOR_TABLE_COEFFICIENTS ? attachCoefficients(values + 2 * _numPoints) : begin();
+        if (!ready)
+            clearTable();
+        return ready;
+    }
+
+    /**
+     * This method saves the calibration points and the calculated coefficients to a byte storage, e.g. EEPROM, flash or a file.
+     * The data is written as a binary calibration table (see 'CalibratorTableHeader') including a version field and a CRC-32.
+     *
+     * @param write Callback that writes a block of bytes to the storage.
+     * @param context Optional pointer that is passed to the callback, e.g. a file handle. Default is 'nullptr'
+     * @param address Optional start address in the storage. Default is 0
+     * @return 'true' if successful, otherwise 'false'.
+     */
+    bool save(CalibratorWriteCallback write, void *context = nullptr, uint32_t address = 0) const
+    {
+        if (_coefficients == nullptr)
+            return false;
+
+        const uint8_t *arrays[3] = {
+            reinterpret_cast<const uint8_t *>(_rawValues),
+            reinterpret_cast<const uint8_t *>(_calibrationValues),
+            reinterpret_cast<const uint8_t *>(_coefficients)};
+        uint32_t lengths[3] = {
+            _numPoints * (uint32_t)sizeof(Numeric),
+            _numPoints * (uint32_t)sizeof(Numeric),
+            coefficientCount(_numPoints) * (uint32_t)sizeof(Numeric)};
+
+        CalibratorTableHeader header;
+        header.magic = CALIBRATOR_TABLE_MAGIC;
+        header.version = CALIBRATOR_TABLE_VERSION;
+        header.numericType = numericType();
+        header.flags = CALIBRATOR_TABLE_COEFFICIENTS | (Interpolation::id << CALIBRATOR_TABLE_INTERPOLATION_SHIFT);
+        header.numPoints = _numPoints;
+        header.checksum = 0;
+        for (uint8_t i = 0; i < 3; i++)
+            header.checksum = calibratorCrc32(arrays[i], lengths[i], header.checksum);
+
+        // Write the header followed by the arrays
+        if (!write(address, reinterpret_cast<const uint8_t *>(&header), sizeof(CalibratorTableHeader), context))
+            return false;
+        address += sizeof(CalibratorTableHeader);
+        for (uint8_t i = 0; i < 3; i++)
+        {
+            if (!write(address, arrays[i], lengths[i], context))
+                return false;
+            address += lengths[i];
+        }
+        return true;
+    }
+
+    /**
+     * This method restores a calibrator saved with 'save()' (or 'storeTable()') from a byte storage.
+     * The data is read with one bulk read into a single allocation; 'begin()' does not have to be called if the table contains the coefficients.
+     * The table is allocated with 'new[]' for every storage policy, also for 'CalibratorInlineStorage'. Without heap, read the table into a buffer of the application and use 'loadTable()'.
+     * Any valid table is accepted; compare 'rawValues()' and 'calibrationValues()' with the expected points if the points may have changed since 'save()'.
+     *
+     * @param read Callback that reads a block of bytes from the storage.
+     * @param context Optional pointer that is passed to the callback, e.g. a file handle. Default is 'nullptr'
+     * @param address Optional start address in the storage. Default is 0
+     * @param maxPoints Optional largest number of calibration points that is accepted, checked before the allocation. Default is 'CALIBRATOR_RESTORE_MAX_POINTS'
+     * @return 'true' if successful, otherwise 'false'. If the data cannot be read, is corrupted, has more than 'maxPoints' points or the memory cannot be allocated, the calibrator keeps its previous state.
+     */
+    bool restore(CalibratorReadCallback read, void *context = nullptr, uint32_t address = 0, uint32_t maxPoints = CALIBRATOR_RESTORE_MAX_POINTS)
+    {
+        CalibratorTableHeader header;
+        if (!read(address, reinterpret_cast<uint8_t *>(&header), sizeof(CalibratorTableHeader), context) || !checkHeader(header))
+            return false;
+
+        // The number of points is not covered by the CRC, so a corrupted value must not size the allocation
+        uint32_t numPoints = header.numPoints;
+        if (numPoints > maxPoints)
+            return false;
+
+        // Read the arrays, reserving space for the coefficients if they were not stored
+        bool withCoefficients = header.flags & CALIBRATOR_TABLE_COEFFICIENTS;
+        uint32_t length = tableSize(numPoints, withCoefficients) - sizeof(CalibratorTableHeader);
+        Numeric *points = new (std::nothrow) Numeric[2 * numPoints + coefficientCount(numPoints)];
+        if (points == nullptr)
+            return false;
+        uint8_t *data = reinterpret_cast<uint8_t *>(points);
+        if (!read(address + sizeof(CalibratorTableHeader), data, length, context) || calibratorCrc32(data, length) != header.checksum)
+        {
+            delete[] points;
+            return false;
+        }
+
+        Numeric *coefficients = points + 2 * numPoints;
+        if (!withCoefficients)
+        {
+            if (!calibratorCheckPoints(points, numPoints))
+            {
+                delete[] points;
+                return false;
+            }
+            Interpolation::prepare(points, points + numPoints, numPoints, coefficients);
+        }
+
+        delete[] _points;
+        _points = points;
+        _numPoints = numPoints;
+        _rawValues = points;
+        _calibrationValues = points + numPoints;
+        return attachCoefficients(coefficients);
+    }
+
+    /**
+     * This method replaces the calibration table by the composition of two calibrators, e.g. ADC code -> millivolts -> state of charge.
+     * The breakpoints are those of the first calibrator and the raw values at which the first calibrator reaches a breakpoint of the second,
+     * so the chain costs a single search and interpolation. With linear interpolation the result equals 'second.calibrate(first.calibrate(x))'
+     * within the raw range of the first calibrator up to rounding; outside, the out-of-range policy of this calibrator applies.
+     * The table is owned by this calibrator and allocated with 'new[]' for every storage policy, 'begin()' does not have to be called.
+     *
+     * @param first Initialized calibrator that is applied first, with any numeric type and policies.
+     * @param second Initialized calibrator that is applied to the result of the first.
+     * @return 'true' if successful, otherwise 'false'. If no usable table results, the calibrator keeps its previous state.
+     */
+    template <typename First, typename Second>
+    bool compose(const First &first, const Second &second)
+    {
+        if (first.numPoints() < 2 || second.numPoints() < 2)
+            return false;
+
+        uint32_t numPoints = composedPoints(first, second, nullptr);
+        Numeric *points = new Numeric[2 * numPoints + coefficientCount(numPoints)];
+        composedPoints(first, second, points);
+        for (uint32_t i = 0; i < numPoints; i++)
+        {
+            typename First::NumericType intermediate = first.calibrate(static_cast<typename First::NumericType>(points[i]));
+            points[numPoints + i] = static_cast<Numeric>(second.calibrate(static_cast<typename Second::NumericType>(intermediate)));
+        }
+        return attachPoints(points, numPoints);
+    }
+
+    /**
+     * This method replaces the calibration table by a scaled copy of another calibrator: 'outputScale * source.calibrate(inputScale * x + inputOffset) + outputOffset'.
+     * Use it to fold a divider or gain correction of the raw value, or a unit conversion of the result, into the table.
+     * The table is owned by this calibrator and allocated with 'new[]' for every storage policy, 'begin()' does not have to be called.
+     *
+     * @param source Calibrator with the calibration points, e.g. this calibrator itself.
+     * @param inputScale Factor of the raw value, must not be 0. A negative factor reverses the table.
+     * @param inputOffset Offset added to the scaled raw value.
+     * @param outputScale Factor of the calibrated value.
+     * @param outputOffset Offset added to the scaled calibrated value.
+     * @return 'true' if successful, otherwise 'false'. If no usable table results, the calibrator keeps its previous state.
+     */
+    template <typename Source>
+    bool compose(const Source &source, Numeric inputScale, Numeric inputOffset, Numeric outputScale, Numeric outputOffset)
+    {
+        uint32_t numPoints = source.numPoints();
+        if (numPoints < 2 || inputScale == 0)
+            return false;
+
+        Numeric *points = new Numeric[2 * numPoints + coefficientCount(numPoints)];
+        for (uint32_t i = 0; i < numPoints; i++)
+        {
+            // A negative factor reverses the order
+            uint32_t k = inputScale > 0 ? i : numPoints - 1 - i;
+            points[i] = (static_cast<Numeric>(source.rawValues()[k]) - inputOffset) / inputScale;
+            points[numPoints + i] = outputScale * static_cast<Numeric>(source.calibrationValues()[k]) + outputOffset;
+        }
+        return attachPoints(points, numPoints);
+    }
+
+    /**
+     * This method writes the calibration points and optionally the calculated coefficients (e.g. slopes and y-intercepts) as a binary calibration table.
+     *
+     * @param table Buffer for the table. Use 'tableSize()' to get the required length.
+     * @param length Length of the buffer in bytes.
+     * @param withCoefficients Optional boolean to also store the coefficients so that 'loadTable()' does not need to recalculate them. Default is 'true'
+     * @return Number of bytes written, or 0 if the buffer is too small or 'begin()' was not successful.
+     */
+    uint32_t storeTable(void *table, uint32_t length, bool withCoefficients = true) const
+    {
+        uint32_t size = tableSize(withCoefficients);
+        if (_coefficients == nullptr || size == 0 || length < size)
+            return 0;
+
+        CalibratorTableHeader header;
+        header.magic = CALIBRATOR_TABLE_MAGIC;
+        header.version = CALIBRATOR_TABLE_VERSION;
+        header.numericType = numericType();
+        header.flags = withCoefficients ? CALIBRATOR_TABLE_COEFFICIENTS | (Interpolation::id << CALIBRATOR_TABLE_INTERPOLATION_SHIFT) : 0;
+        header.numPoints = _numPoints;
+
+        // Copy the arrays behind the header
+        uint8_t *data = static_cast<uint8_t *>(table) + sizeof(CalibratorTableHeader);
+        uint32_t pointsSize = _numPoints * sizeof(Numeric);
+        memcpy(data, _rawValues, pointsSize);
+        memcpy(data + pointsSize, _calibrationValues, pointsSize);
+        if (withCoefficients)
+            memcpy(data + 2 * pointsSize, _coefficients, coefficientCount(_numPoints) * sizeof(Numeric));
+
+        header.checksum = calibratorCrc32(data, size - sizeof(CalibratorTableHeader));
+        memcpy(table, &header, sizeof(CalibratorTableHeader));
+        return size;
+    }
+
+    /**
+     * Returns the size of the binary calibration table of this calibrator in bytes.
+     *
+     * @param withCoefficients Optional boolean whether the coefficients are included. Default is 'true'
+     */
+    uint32_t tableSize(bool withCoefficients = true) const
+    {
+        return _numPoints > 1 ? tableSize(_numPoints, withCoefficients) : 0;
+    }
+
+    /**
+     * Returns the number of calibration points.
+     */
+    uint32_t numPoints() const
+    {
+        return _numPoints;
+    }
+
+    /**
+     * Returns the raw values of the calibration points.
+     */
+    const Numeric *rawValues() const
+    {
+        return _rawValues;
+    }
+
+    /**
+     * Returns the calibrated values of the calibration points.
+     */
+    const Numeric *calibrationValues() const
+    {
+        return _calibrationValues;
+    }
+
+    /**
+     * Returns the number of values that 'begin()' needs from the storage for the coefficients and the search data.
+     * Use it to size the buffer passed to 'storage().assign()' with 'CalibratorExternalStorage'.
+     *
+     * @param options Optional options that will be passed to 'begin()'. Default is 0
+     */
+    uint32_t storageSize(uint8_t options = 0) const
+    {
+        if (_numPoints <= 1)
+            return 0;
+        return coefficientCount(_numPoints) + Search::size(_numPoints) + (options & CALIBRATOR_INTEGRALS ? _numPoints : 0) +
+               (options & CALIBRATOR_EXTREMA ? 4 * (_numPoints - 1) : 0);
+    }
+
+    /**
+     * Returns the storage of the coefficients and the search data.
+     */
+    StorageBuffer &storage()
+    {
+        return _storage;
+    }
+
+    /**
+     * This method calibrates a raw value against a calibration table.
+     *
+     * @param rawValue A raw numeric value to be calibrated.
+     * @return A numeric, calibrated value.
+     */
+    Numeric calibrate(Numeric rawValue) const
+    {
+        if (_coefficients == nullptr)
+            return rawValue;
+
+        // Kalibrierfunktion
+        return calibrateSegment(rawValue, Search::find(_rawValues, _numPoints, _searchData, rawValue));
+    }
+
+    /**
+     * This method calibrates a raw value and starts with the segment of the previous call, e.g. for slowly changing signals or a lazy iterator over samples.
+     * Only if the raw value is not inside this segment the breakpoints are searched. The result is the same as that of 'calibrate(rawValue)'.
+     *
+     * @param rawValue A raw numeric value to be calibrated.
+     * @param segment Segment hint; receives the segment of the raw value for the next call. Start with 0
+     * @return A numeric, calibrated value.
+     */
+    Numeric calibrate(Numeric rawValue, uint32_t &segment) const
+    {
+        if (_coefficients == nullptr)
+            return rawValue;
+
+        if (!isInSegment(rawValue, segment))
+            segment = Search::find(_rawValues, _numPoints, _searchData, rawValue);
+        return calibrateSegment(rawValue, segment);
+    }
+
+    /**
+     * This method calibrates a block of samples in place, e.g. a DMA half-buffer from within the half-transfer callback.
+     * Every sample costs at most one search over the breakpoints. With the default search these are up to 'numPoints - 2' compares for tables with up to 'CALIBRATOR_SMALL_TABLE' points
+     * (vectorized only for 'float' and 'double') and about 'log2(numPoints)' steps for larger tables. For a known worst-case execution time, e.g. in an interrupt,
+     * use 'CalibratorFixedDepthSearch', whose every search takes 'CalibratorFixedDepthSearch::steps(numPoints)' steps.
+     * Runs of 'CALIBRATOR_RUN_LENGTH' samples within one segment, typical for slowly changing signals, are calibrated without search and range checks.
+     *
+     * @param buffer Array of raw samples that is overwritten with the calibrated values.
+     * @param count Number of samples in the array.
+     */
+    template <typename Sample>
+    void calibrateBlock(Sample *buffer, uint32_t count) const
+    {
+        calibrateBlock(buffer, buffer, count);
+    }
+
+    /**
+     * This method calibrates a block of samples into a separate output buffer, e.g. the matching half of a ping-pong buffer.
+     * Input and output may have a different type than the calibrator. Integer outputs are rounded to the nearest value.
+     *
+     * @param input Array of raw samples to calibrate.
+     * @param output Array that receives the calibrated values. May be the same array as 'input'.
+     * @param count Number of samples in the arrays.
+     */
+    template <typename Sample, typename Output>
+    void calibrateBlock(const Sample *input, Output *output, uint32_t count) const
+    {
+        calibrateBlock(input, 1, output, 1, count);
+    }
+
+    /**
+     * This method calibrates every n-th sample of a buffer, e.g. one channel of an interleaved multi-channel scan buffer, without copying it first.
+     *
+     * @param input Pointer to the first raw sample of the channel.
+     * @param inputStride Distance between two consecutive raw samples in elements (the number of channels of the frame).
+     * @param output Pointer to the first calibrated value.
+     * @param outputStride Distance between two consecutive calibrated values in elements. Use 1 to de-interleave into a contiguous array.
+     * @param count Number of samples to calibrate.
+     */
+    template <typename Sample, typename Output>
+    void calibrateBlock(const Sample *input, uint32_t inputStride, Output *output, uint32_t outputStride, uint32_t count) const
+    {
+        if (_coefficients == nullptr)
+        {
+            for (uint32_t i = 0; i < count; i++)
+                output[i * outputStride] = convertSample<Output>(static_cast<Numeric>(input[i * inputStride]));
+            return;
+        }
+
+        // The block is processed in runs; samples of a slowly changing signal usually stay in one segment for a whole run
+        uint32_t segment = 0;
+        uint32_t backoff = 1; // Runs that are calibrated sample by sample after a run across a segment boundary, doubled up to 64 for signals without runs
+        uint32_t start = 0;
+        while (start < count)
+        {
+            uint32_t length = count - start < CALIBRATOR_RUN_LENGTH ? count - start : CALIBRATOR_RUN_LENGTH;
+            const Sample *in = input + start * inputStride;
+            Output *out = output + start * outputStride;
+
+            // Smallest and largest raw value of the run
+            Numeric low = static_cast<Numeric>(in[0]);
+            Numeric high = low;
+            bool ordered = low == low; // 'false' for NaN, which is not between 'low' and 'high'
+            for (uint32_t k = 1; k < length; k++)
+            {
+                Numeric rawValue = static_cast<Numeric>(in[k * inputStride]);
+                low = rawValue < low ? rawValue : low;
+                high = rawValue > high ? rawValue : high;
+                ordered = ordered && rawValue == rawValue;
+            }
+
+            // All raw values within the calibration range and in the same segment: no search and no range check
+            if (ordered && low >= _rawValues[0] && high <= _rawValues[_numPoints - 1])
+            {
+                if (!isInSegment(low, segment))
+                    segment = Search::find(_rawValues, _numPoints, _searchData, low);
+                if (isInSegment(high, segment))
+                {
+                    for (uint32_t k = 0; k < length; k++)
+                        out[k * outputStride] = convertSample<Output>(Interpolation::evaluate(_rawValues, _coefficients, _numPoints - 1, segment, static_cast<Numeric>(in[k * inputStride])));
+                    start += length;
+                    backoff = 1;
+                    continue;
+                }
+            }
+
+            // The run crosses a segment boundary: the following raw values one by one
+            uint32_t end = count - start < backoff * CALIBRATOR_RUN_LENGTH ? count : start + backoff * CALIBRATOR_RUN_LENGTH;
+            calibrateEach(input + start * inputStride, inputStride, output + start * outputStride, outputStride, end - start);
+            start = end;
+            backoff = backoff < 64 ? 2 * backoff : 64;
+        }
+    }
+
+    /**
+     * This method calibrates an ascending sequence of raw values, e.g. histogram bin centers or a verification grid.
+     * Instead of a search per value, a segment pointer moves forward through the breakpoints, so the whole sequence costs about 'count + numPoints' steps.
+     * Values that are smaller than their predecessor or far ahead of it are searched as usual, so the result is correct for any order.
+     *
+     * @param input Array of raw samples to calibrate, preferably in ascending order.
+     * @param output Array that receives the calibrated values. May be the same array as 'input'.
+     * @param count Number of samples in the arrays.
+     */
+    template <typename Sample, typename Output>
+    void calibrateSorted(const Sample *input, Output *output, uint32_t count) const
+    {
+        if (_coefficients == nullptr)
+        {
+            calibrateBlock(input, output, count);
+            return;
+        }
+
+        uint32_t last = _numPoints - 2;
+        uint32_t i = 0;
+        for (uint32_t k = 0; k < count; k++)
+        {
+            Numeric rawValue = static_cast<Numeric>(input[k]);
+
+            // Forward to the segment of the raw value; a few steps only, so that unsorted values do not scan the whole table
+            for (uint8_t step = 0; step < 4 && i < last && rawValue > _rawValues[i + 1]; step++)
+                i++;
+
+            // Further away or smaller than the previous raw value: normal search
+            if (!isInSegment(rawValue, i))
+                i = Search::find(_rawValues, _numPoints, _searchData, rawValue);
+
+            output[k] = convertSample<Output>(calibrateSegment(rawValue, i));
+        }
+    }
+
+    /**
+     * This method returns the mean of the calibrated values of a block, e.g. of an oversampled reading.
+     * Linear and step interpolation are affine within a segment, so the calibrated values do not have to be computed one by one:
+     * if all samples lie in one segment, only the sum of the raw values is calibrated; otherwise the sums of runs in the same segment are calibrated.
+     * The result equals the mean of 'calibrate()' of all samples up to rounding.
+     *
+     * @param input Array of raw samples.
+     * @param count Number of samples in the array.
+     * @return The mean of the calibrated values, 0 if 'count' is 0.
+     */
+    template <typename Sample>
+    Numeric calibrateMean(const Sample *input, uint32_t count) const
+    {
+        if (count == 0)
+            return 0;
+
+        Sum total = 0;
+        if (_coefficients == nullptr)
+        {
+            for (uint32_t k = 0; k < count; k++)
+                total += static_cast<Numeric>(input[k]);
+        }
+        else
+        {
+            total = sumCalibrated(input, count, std::integral_constant<bool, Interpolation::affine>());
+        }
+        return static_cast<Numeric>(total / static_cast<Sum>(count));
+    }
+
+    /**
+     * This method returns the integral of the calibrated value over a raw interval, e.g. the charge from a current curve.
+     * With 'begin(CALIBRATOR_INTEGRALS)' it costs two searches, otherwise the segments in between are integrated as well.
+     * Outside the calibration range the out-of-range policy is integrated with Simpson's rule, which is exact for the constant, linear and cubic continuations. Intended for floating point types.
+     *
+     * @param from Raw value at the start of the interval.
+     * @param to Raw value at the end of the interval. If smaller than 'from', the integral is negative.
+     * @return The integral, 0 if 'begin()' was not successful.
+     */
+    Numeric integrate(Numeric from, Numeric to) const
+    {
+        if (_coefficients == nullptr)
+            return 0;
+        return integralTo(to) - integralTo(from);
+    }
+
+    /**
+     * This method returns the mean calibrated value over a raw interval, i.e. the integral divided by the length of the interval.
+     *
+     * @param from Raw value at the start of the interval.
+     * @param to Raw value at the end of the interval.
+     * @return The mean calibrated value, the calibrated value if both are equal.
+     */
+    Numeric average(Numeric from, Numeric to) const
+    {
+        if (from == to)
+            return calibrate(from);
+        return integrate(from, to) / (to - from);
+    }
+
+    /**
+     * This method returns the smallest and the largest calibrated value for the raw values of an interval, e.g. to check alarm limits against a sensor range.
+     * With 'begin(CALIBRATOR_EXTREMA)' the segments in between are looked up in a segment tree in O(log n), otherwise every segment in between is checked.
+     * The partial segments at both ends and the parts outside the calibration range are evaluated exactly.
+     *
+     * @param from Raw value at one end of the interval.
+     * @param to Raw value at the other end of the interval.
+     * @param minimum Receives the smallest calibrated value.
+     * @param maximum Receives the largest calibrated value.
+     * @return 'true' if successful, 'false' if 'begin()' was not successful or a raw value is NaN.
+     */
+    bool extrema(Numeric from, Numeric to, Numeric &minimum, Numeric &maximum) const
+    {
+        if (_coefficients == nullptr || from != from || to != to)
+            return false;
+        if (to < from)
+        {
+            Numeric value = from;
+            from = to;
+            to = value;
+        }
+
+        uint32_t last = _numPoints - 1;
+        bool found = false;
+
+        // Parts outside the range
+        if (from < _rawValues[0])
+            extendOutside(from, to < _rawValues[0] ? to : _rawValues[0], true, minimum, maximum, found);
+        if (to > _rawValues[last])
+            extendOutside(from > _rawValues[last] ? from : _rawValues[last], to, false, minimum, maximum, found);
+
+        // Part within the range: partial segments at both ends, complete segments in between
+        Numeric low = from > _rawValues[0] ? from : _rawValues[0];
+        Numeric high = to < _rawValues[last] ? to : _rawValues[last];
+        if (low <= high)
+        {
+            uint32_t firstSegment = Search::find(_rawValues, _numPoints, _searchData, low);
+            uint32_t lastSegment = Search::find(_rawValues, _numPoints, _searchData, high);
+            Numeric segmentLow, segmentHigh;
+            if (firstSegment == lastSegment)
+            {
+                Interpolation::extrema(_rawValues, _coefficients, last, firstSegment, low, high, segmentLow, segmentHigh);
+                extend(segmentLow, segmentHigh, minimum, maximum, found);
+            }
+            else
+            {
+                Interpolation::extrema(_rawValues, _coefficients, last, firstSegment, low, _rawValues[firstSegment + 1], segmentLow, segmentHigh);
+                extend(segmentLow, segmentHigh, minimum, maximum, found);
+                Interpolation::extrema(_rawValues, _coefficients, last, lastSegment, _rawValues[lastSegment], high, segmentLow, segmentHigh);
+                extend(segmentLow, segmentHigh, minimum, maximum, found);
+                if (firstSegment + 1 < lastSegment)
+                    extendSegments(firstSegment + 1, lastSegment - 1, minimum, maximum, found);
+            }
+        }
+        return true;
+    }
+
+    /**
+     * This method converts thresholds of the calibrated value (e.g. 10 % state of charge) into the raw domain once,
+     * so that alarm checks can classify raw samples with 'classify()' without calibrating them.
+     * The calibration curve must be monotone (rising or falling). Each raw threshold is found by bisection with 'calibrate()',
+     * so the classification agrees exactly with comparing 'calibrate(x)' with the thresholds, also outside the calibration range:
+     * where the out-of-range policy extends the end segments (e.g. 'CalibratorLimitFlag' without limit or 'CalibratorExtrapolate'), the threshold is searched along the extended segment;
+     * where it returns the first or last calibration value, thresholds that are not reached there are never reached.
+     * Other out-of-range policies (e.g. 'CalibratorSaturate', 'CalibratorNaN') and extended cubic segments, which need not be monotone, are refused.
+     * Integer types have no infinity, so their lowest and largest values stand for thresholds that are always or never reached; the raw value equal to that limit may be classified differently.
+     *
+     * @param thresholds Array of thresholds of the calibrated value, in any order.
+     * @param rawThresholds Array that receives the raw thresholds for 'classify()'.
+     * @param count Number of thresholds.
+     * @return 'true' if successful, 'false' if 'begin()' was not successful, the curve is not monotone or the out-of-range policy is not supported.
+     */
+    bool rawThresholds(const Numeric *thresholds, Numeric *rawThresholds, uint32_t count) const
+    {
+        if (_coefficients == nullptr)
+            return false;
+
+        bool rising = _calibrationValues[0] <= _calibrationValues[_numPoints - 1];
+        if (!isMonotone())
+            return false;
+
+        // Out-of-range behaviour on both sides: 0 returns the calibration value, 1 extends the end segment
+        int8_t belowMode = outOfRangeMode(true);
+        int8_t aboveMode = outOfRangeMode(false);
+        if (belowMode < 0 || aboveMode < 0)
+            return false;
+
+        Numeric lowest = std::numeric_limits<Numeric>::has_infinity ? -std::numeric_limits<Numeric>::infinity() : std::numeric_limits<Numeric>::lowest();
+        Numeric highest = std::numeric_limits<Numeric>::has_infinity ? std::numeric_limits<Numeric>::infinity() : std::numeric_limits<Numeric>::max();
+        for (uint32_t k = 0; k < count; k++)
+        {
+            // Rising: largest raw value below the threshold; falling: largest raw value that reaches it
+            Numeric low = _rawValues[0];
+            Numeric high = _rawValues[_numPoints - 1];
+            bool lowReaches = calibrate(low) >= thresholds[k];
+            bool highReaches = calibrate(high) >= thresholds[k];
+            if (lowReaches == highReaches)
+            {
+                // Within the range the threshold is always or never reached, so it can only change on one side outside the range
+                bool above = lowReaches != rising;
+                if (!(above ? aboveMode : belowMode) || !findOutside(thresholds[k], above, rising, lowReaches, low, high))
+                {
+                    rawThresholds[k] = lowReaches == rising ? lowest : highest;
+                    continue;
+                }
+                lowReaches = calibrate(low) >= thresholds[k];
+            }
+
+            // Bisect down to adjacent raw values
+            for (;;)
+            {
+                Numeric middle = midpoint(low, high);
+                if (!(low < middle && middle < high))
+                    break;
+                if ((calibrate(middle) >= thresholds[k]) == lowReaches)
+                    low = middle;
+                else
+                    high = middle;
+            }
+            rawThresholds[k] = low;
+        }
+        return true;
+    }
+
+    /**
+     * This method classifies a raw sample by thresholds from 'rawThresholds()' with one compare per threshold and without branches.
+     *
+     * @param rawThresholds Array of raw thresholds from 'rawThresholds()'.
+     * @param count Number of thresholds.
+     * @param rawValue A raw numeric value.
+     * @return The number of thresholds that the calibrated value reaches or exceeds, e.g. the index of the band for ascending thresholds.
+     */
+    uint32_t classify(const Numeric *rawThresholds, uint32_t count, Numeric rawValue) const
+    {
+        uint32_t below = calibratorCountLess(rawThresholds, count, rawValue);
+        return _calibrationValues[0] <= _calibrationValues[_numPoints - 1] ? below : count - below;
+    }
+
+    /**
+     * This method transforms a histogram of raw values into a histogram of calibrated values without calibrating single samples, e.g. for summaries built on the device.
+     * The bin edges are calibrated, and bins that contain calibration points are split there with the counts divided in proportion to the raw widths,
+     * so that each output bin lies within one segment. The calibration curve must be monotone; for a falling curve the output is reversed so that the edges ascend.
+     *
+     * @param edges Array of 'bins + 1' ascending raw bin edges.
+     * @param counts Array of the counts of the bins.
+     * @param bins Number of bins.
+     * @param calibratedEdges Array that receives the calibrated bin edges, one more than the number of output bins.
+     * @param calibratedCounts Array that receives the counts of the output bins, e.g. 'float' because split bins get fractional counts.
+     * @param capacity Number of output bins that fit into 'calibratedCounts'. 'bins + numPoints()' is always sufficient.
+     * @return The number of output bins, or 0 if 'begin()' was not successful, the curve is not monotone or the capacity is too small.
+     */
+    template <typename Count, typename Weight>
+    uint32_t calibrateHistogram(const Numeric *edges, const Count *counts, uint32_t bins, Numeric *calibratedEdges, Weight *calibratedCounts, uint32_t capacity) const
+    {
+        if (_coefficients == nullptr || bins == 0 || !isMonotone())
+            return 0;
+
+        // First calibration point within the histogram
+        uint32_t j = 0;
+        while (j < _numPoints && !(_rawValues[j] > edges[0]))
+            j++;
+
+        uint32_t n = 0;
+        calibratedEdges[0] = calibrate(edges[0]);
+        for (uint32_t b = 0; b < bins; b++)
+        {
+            Numeric start = edges[b];
+            Numeric width = edges[b + 1] - edges[b];
+            Weight remaining = static_cast<Weight>(counts[b]);
+
+            // Split the bin at the calibration points
+            for (; j < _numPoints && _rawValues[j] < edges[b + 1]; j++)
+            {
+                if (!(_rawValues[j] > start))
+                    continue;
+                if (n == capacity)
+                    return 0;
+                Weight part = static_cast<Weight>(counts[b]) * static_cast<Weight>(_rawValues[j] - start) / static_cast<Weight>(width);
+                calibratedCounts[n] = part;
+                remaining -= part;
+                start = _rawValues[j];
+                calibratedEdges[++n] = calibrate(start);
+            }
+
+            // The last part gets the remaining count, so the total count is kept exactly
+            if (n == capacity)
+                return 0;
+            calibratedCounts[n] = remaining;
+            calibratedEdges[++n] = calibrate(edges[b + 1]);
+        }
+
+        // Falling curve: restore ascending order
+        if (_calibrationValues[0] > _calibrationValues[_numPoints - 1])
+        {
+            for (uint32_t i = 0, k = n; i < k; i++, k--)
+            {
+                Numeric edge = calibratedEdges[i];
+                calibratedEdges[i] = calibratedEdges[k];
+                calibratedEdges[k] = edge;
+            }
+            for (uint32_t i = 0, k = n - 1; i < k; i++, k--)
+            {
+                Weight count = calibratedCounts[i];
+                calibratedCounts[i] = calibratedCounts[k];
+                calibratedCounts[k] = count;
+            }
+        }
+        return n;
+    }
+
+    /**
+     * This method calibrates a buffer of interleaved frames with a separate calibrator for each channel (lane) in a single sweep.
+     *
+     * @param calibrators Array with one calibrator per channel.
+     * @param numChannels Number of channels per frame.
+     * @param input Array of interleaved raw frames (ch0, ch1, ..., ch0, ch1, ...).
+     * @param output Array that receives the interleaved calibrated frames. May be the same array as 'input'.
+     * @param numFrames Number of frames in the arrays.
+     */
+    template <typename Sample, typename Output>
+    static void calibrateInterleaved(const Calibrator *const *calibrators, uint32_t numChannels, const Sample *input, Output *output, uint32_t numFrames)
+    {
+        for (uint32_t frame = 0; frame < numFrames; frame++)
+        {
+            for (uint32_t channel = 0; channel < numChannels; channel++)
+            {
+                uint32_t i = frame * numChannels + channel;
+                output[i] = convertSample<Output>(calibrators[channel]->calibrate(static_cast<Numeric>(input[i])));
+            }
+        }
+    }
+
+private:
+    /**
+     * Evaluates the interpolation of a segment and applies the out-of-range policy.
+     */
+    Numeric calibrateSegment(Numeric rawValue, uint32_t i) const
+    {
+        Numeric calibratedValue = Interpolation::evaluate(_rawValues, _coefficients, _numPoints - 1, i, rawValue); // Anwenden der Kalibrierfunktion
+
+        // Is the value outside the range? Both compares are always made, so that every raw value takes the same number of operations
+        bool below = rawValue < _rawValues[0];              // Prüfe ob Rohwert kleiner als der erste Kalibrierpunkt ist
+        bool above = rawValue > _rawValues[_numPoints - 1]; // Prüfe ob Rohwert größer als der letzte Kalibrierpunkt ist
+        if (below)
+            return OutOfRange::below(calibratedValue, _calibrationValues[0], _limitOutput);
+        if (above)
+            return OutOfRange::above(calibratedValue, _calibrationValues[_numPoints - 1], _limitOutput);
+
+        return calibratedValue;
+    }
+
+    /**
+     * Calibrates samples one by one. Kept out of 'calibrateBlock()' so that the compiler optimizes this loop on its own.
+     */
+    template <typename Sample, typename Output>
+    void calibrateEach(const Sample *input, uint32_t inputStride, Output *output, uint32_t outputStride, uint32_t count) const
+    {
+        for (uint32_t k = 0; k < count; k++)
+            output[k * outputStride] = convertSample<Output>(calibrate(static_cast<Numeric>(input[k * inputStride])));
+    }
+
+    /**
+     * Writes the raw values of the composition of two calibrators and returns their number; only counts them if 'rawValues' is 'nullptr'.
+     */
+    template <typename First, typename Second>
+    static uint32_t composedPoints(const First &first, const Second &second, Numeric *rawValues)
+    {
+        const typename First::NumericType *firstRaw = first.rawValues();
+        const typename Second::NumericType *secondRaw = second.rawValues();
+        uint32_t secondPoints = second.numPoints();
+
+        uint32_t n = 0;
+        for (uint32_t i = 0; i < first.numPoints(); i++)
+        {
+            Numeric a = static_cast<Numeric>(firstRaw[i]);
+            if (rawValues != nullptr)
+                rawValues[n] = a;
+            n++;
+            if (i == first.numPoints() - 1)
+                break;
+
+            // Raw values at which this segment reaches the calibration points of the second calibrator, in ascending order
+            Numeric b = static_cast<Numeric>(firstRaw[i + 1]);
+            Numeric ya = static_cast<Numeric>(first.calibrate(firstRaw[i]));
+            Numeric yb = static_cast<Numeric>(first.calibrate(firstRaw[i + 1]));
+            Numeric last = a;
+            for (uint32_t j = 0; j < secondPoints; j++)
+            {
+                Numeric y = static_cast<Numeric>(secondRaw[ya < yb ? j : secondPoints - 1 - j]);
+                if (!((ya < y && y < yb) || (yb < y && y < ya)))
+                    continue;
+
+                Numeric x = a + (y - ya) * (b - a) / (yb - ya);
+                if (x > last && x < b)
+                {
+                    if (rawValues != nullptr)
+                        rawValues[n] = x;
+                    n++;
+                    last = x;
+                }
+            }
+        }
+        return n;
+    }
+
+    /**
+     * Uses an allocated table of calibration points (raw values, calibrated values and space for the coefficients) as calibration table.
+     */
+    bool attachPoints(Numeric *points, uint32_t numPoints)
+    {
+        if (!calibratorCheckPoints(points, numPoints))
+        {
+            delete[] points;
+            return false;
+        }
+
+        Numeric *coefficients = points + 2 * numPoints;
+        Interpolation::prepare(points, points + numPoints, numPoints, coefficients);
+
+        delete[] _points;
+        _points = points;
+        _numPoints = numPoints;
+        _rawValues = points;
+        _calibrationValues = points + numPoints;
+        return attachCoefficients(coefficients);
+    }
+
+    /**
+     * Sum of the calibrated values of a block for affine interpolations.
+     */
+    template <typename Sample>
+    Sum sumCalibrated(const Sample *input, uint32_t count, std::true_type) const
+    {
+        // Sum, smallest and largest raw value of the block
+        Numeric low = static_cast<Numeric>(input[0]);
+        Numeric high = low;
+        Sum rawSum = low;
+        bool ordered = low == low; // 'false' for NaN, which is not between 'low' and 'high'
+        for (uint32_t k = 1; k < count; k++)
+        {
+            Numeric rawValue = static_cast<Numeric>(input[k]);
+            low = rawValue < low ? rawValue : low;
+            high = rawValue > high ? rawValue : high;
+            rawSum += rawValue;
+            ordered = ordered && rawValue == rawValue;
+        }
+
+        // All raw values within the calibration range and in the same segment: calibrate the sum only
+        if (ordered && low >= _rawValues[0] && high <= _rawValues[_numPoints - 1])
+        {
+            uint32_t segment = Search::find(_rawValues, _numPoints, _searchData, low);
+            if (isInSegment(high, segment))
+                return Interpolation::sum(_rawValues, _coefficients, _numPoints - 1, segment, rawSum, count);
+        }
+
+        // Otherwise calibrate the sums of the runs within one segment, and raw values outside the range one by one
+        Sum total = 0;
+        Sum runSum = 0;
+        uint32_t runCount = 0;
+        uint32_t segment = 0;
+        for (uint32_t k = 0; k < count; k++)
+        {
+            Numeric rawValue = static_cast<Numeric>(input[k]);
+            if (rawValue >= _rawValues[0] && rawValue <= _rawValues[_numPoints - 1])
+            {
+                if (!isInSegment(rawValue, segment))
+                {
+                    if (runCount > 0)
+                        total += Interpolation::sum(_rawValues, _coefficients, _numPoints - 1, segment, runSum, runCount);
+                    segment = Search::find(_rawValues, _numPoints, _searchData, rawValue);
+                    runSum = 0;
+                    runCount = 0;
+                }
+                runSum += rawValue;
+                runCount++;
+            }
+            else
+            {
+                total += calibrate(rawValue);
+            }
+        }
+        if (runCount > 0)
+            total += Interpolation::sum(_rawValues, _coefficients, _numPoints - 1, segment, runSum, runCount);
+        return total;
+    }
+
+    /**
+     * Sum of the calibrated values of a block for other interpolations, e.g. cubic.
+     */
+    template <typename Sample>
+    Sum sumCalibrated(const Sample *input, uint32_t count, std::false_type) const
+    {
+        Sum total = 0;
+        for (uint32_t k = 0; k < count; k++)
+            total += calibrate(static_cast<Numeric>(input[k]));
+        return total;
+    }
+
+    /**
+     * Integral from the first calibration point to a raw value.
+     */
+    Numeric integralTo(Numeric rawValue) const
+    {
+        uint32_t last = _numPoints - 1;
+
+        // Outside the range: Simpson's rule over the values of the out-of-range policy, exact for constant, linear and cubic continuations
+        if (rawValue < _rawValues[0])
+            return -outsideIntegral(rawValue, _rawValues[0], true);
+        if (rawValue > _rawValues[last])
+            return integralAt(last) + outsideIntegral(_rawValues[last], rawValue, false);
+
+        uint32_t i = Search::find(_rawValues, _numPoints, _searchData, rawValue);
+        return integralAt(i) + Interpolation::integrate(_rawValues, _coefficients, last, i, _rawValues[i], rawValue);
+    }
+
+    /**
+     * Integral of the out-of-range policy between a calibration range end and a raw value outside the range.
+     */
+    Numeric outsideIntegral(Numeric from, Numeric to, bool below) const
+    {
+        uint32_t last = _numPoints - 1;
+        Numeric values[3];
+        Numeric rawValues[3] = {from, static_cast<Numeric>(from + (to - from) / 2), to};
+        for (uint8_t k = 0; k < 3; k++)
+        {
+            if (below)
+                values[k] = OutOfRange::below(Interpolation::evaluate(_rawValues, _coefficients, last, 0, rawValues[k]), _calibrationValues[0], _limitOutput);
+            else
+                values[k] = OutOfRange::above(Interpolation::evaluate(_rawValues, _coefficients, last, last - 1, rawValues[k]), _calibrationValues[last], _limitOutput);
+        }
+        return (to - from) * (values[0] + 4 * values[1] + values[2]) / 6;
+    }
+
+    /**
+     * Extends the extrema by the out-of-range policy between a calibration range end and a raw value outside the range.
+     * The built-in policies return either the extrapolated value or a constant, so the policy is applied to the extrema of the extrapolated polynomial.
+     */
+    void extendOutside(Numeric from, Numeric to, bool below, Numeric &minimum, Numeric &maximum, bool &found) const
+    {
+        uint32_t last = _numPoints - 1;
+        Numeric low, high;
+        if (below)
+        {
+            Interpolation::extrema(_rawValues, _coefficients, last, 0, from, to, low, high);
+            low = OutOfRange::below(low, _calibrationValues[0], _limitOutput);
+            high = OutOfRange::below(high, _calibrationValues[0], _limitOutput);
+        }
+        else
+        {
+            Interpolation::extrema(_rawValues, _coefficients, last, last - 1, from, to, low, high);
+            low = OutOfRange::above(low, _calibrationValues[last], _limitOutput);
+            high = OutOfRange::above(high, _calibrationValues[last], _limitOutput);
+        }
+        extend(low < high ? low : high, low < high ? high : low, minimum, maximum, found);
+    }
+
+    /**
+     * Extends the extrema by the complete segments 'firstSegment' to 'lastSegment', from the segment tree or segment by segment.
+     */
+    void extendSegments(uint32_t firstSegment, uint32_t lastSegment, Numeric &minimum, Numeric &maximum, bool &found) const
+    {
+        uint32_t segments = _numPoints - 1;
+        if (_extrema == nullptr)
+        {
+            for (uint32_t i = firstSegment; i <= lastSegment; i++)
+            {
+                Numeric low, high;
+                Interpolation::extrema(_rawValues, _coefficients, segments, i, _rawValues[i], _rawValues[i + 1], low, high);
+                extend(low, high, minimum, maximum, found);
+            }
+            return;
+        }
+
+        // Upwards from the leaves until the left and right bounds meet
+        const Numeric *minima = _extrema;
+        const Numeric *maxima = _extrema + 2 * segments;
+        for (uint32_t left = firstSegment + segments, right = lastSegment + segments + 1; left < right; left >>= 1, right >>= 1)
+        {
+            if (left & 1)
+            {
+                extend(minima[left], maxima[left], minimum, maximum, found);
+                left++;
+            }
+            if (right & 1)
+            {
+                right--;
+                extend(minima[right], maxima[right], minimum, maximum, found);
+            }
+        }
+    }
+
+    /**
+     * Extends the extrema by the extrema of a part of the curve.
+     */
+    static void extend(Numeric low, Numeric high, Numeric &minimum, Numeric &maximum, bool &found)
+    {
+        if (!found || low < minimum)
+            minimum = low;
+        if (!found || high > maximum)
+            maximum = high;
+        found = true;
+    }
+
+    /**
+     * Integral from the first calibration point to calibration point i, precalculated or summed up.
+     */
+    Numeric integralAt(uint32_t i) const
+    {
+        if (_integrals != nullptr)
+            return _integrals[i];
+
+        Numeric integral = 0;
+        for (uint32_t k = 0; k < i; k++)
+            integral += Interpolation::integrate(_rawValues, _coefficients, _numPoints - 1, k, _rawValues[k], _rawValues[k + 1]);
+        return integral;
+    }
+
+    /**
+     * Returns how the out-of-range policy continues the curve on one side: 0 with the calibration value at the end, 1 with the extended end segment,
+     * -1 otherwise (e.g. a constant or NaN), in which case the curve outside the range is not monotone with the curve inside.
+     * The policy is probed with two pairs of extended and calibration values, which distinguishes the cases for every policy of this form.
+     */
+    int8_t outOfRangeMode(bool below) const
+    {
+        Numeric first = below ? OutOfRange::below(Numeric(1), Numeric(0), _limitOutput) : OutOfRange::above(Numeric(1), Numeric(0), _limitOutput);
+        Numeric second = below ? OutOfRange::below(Numeric(2), Numeric(3), _limitOutput) : OutOfRange::above(Numeric(2), Numeric(3), _limitOutput);
+        if (first == Numeric(0) && second == Numeric(3))
+            return 0;
+        // An extended cubic segment may turn back
+        if (first == Numeric(1) && second == Numeric(2) && Interpolation::affine)
+            return 1;
+        return -1;
+    }
+
+    /**
+     * Searches outwards from one end of the calibration range, with doubling steps, for a raw value at which the threshold changes from the state inside the range.
+     * If the extended segment stops rising or falling, its calibrated value has overflowed, so the step is halved instead.
+     * On success 'low' and 'high' enclose the change.
+     */
+    bool findOutside(Numeric threshold, bool above, bool rising, bool insideReaches, Numeric &low, Numeric &high) const
+    {
+        Numeric step = _rawValues[_numPoints - 1] - _rawValues[0];
+        if (!(step > Numeric(0)))
+            step = Numeric(1);
+        Numeric inner = above ? _rawValues[_numPoints - 1] : _rawValues[0];
+        Numeric innerValue = calibrate(inner);
+        Numeric limit = above ? std::numeric_limits<Numeric>::max() : std::numeric_limits<Numeric>::lowest();
+        while (inner != limit && step > Numeric(0))
+        {
+            Numeric outer;
+            if (above)
+                outer = inner > limit - step ? limit : inner + step;
+            else
+                outer = inner < limit + step ? limit : inner - step;
+
+            Numeric outerValue = calibrate(outer);
+            if (above == rising ? outerValue < innerValue : outerValue > innerValue)
+            {
+                step = step / 2;
+                continue;
+            }
+            if ((outerValue >= threshold) != insideReaches)
+            {
+                low = above ? inner : outer;
+                high = above ? outer : inner;
+                return true;
+            }
+            inner = outer;
+            innerValue = outerValue;
+            step = step > std::numeric_limits<Numeric>::max() / 2 ? std::numeric_limits<Numeric>::max() : step * 2;
+        }
+        return false;
+    }
+
+    /**
+     * Returns a value between two values without overflow of their difference, also for the limits of the type.
+     */
+    static Numeric midpoint(Numeric low, Numeric high)
+    {
+        if ((low < Numeric(0)) != (high < Numeric(0)))
+            return (low + high) / 2;
+        return low + (high - low) / 2;
+    }
+
+    /**
+     * Checks that the calibration values are rising or falling throughout.
+     */
+    bool isMonotone() const
+    {
+        bool rising = _calibrationValues[0] <= _calibrationValues[_numPoints - 1];
+        for (uint32_t i = 0; i < _numPoints - 1; i++)
+        {
+            if (rising ? _calibrationValues[i + 1] < _calibrationValues[i] : _calibrationValues[i + 1] > _calibrationValues[i])
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * Checks if the search would return the given segment for a raw value: the first segment whose upper breakpoint is not below the raw value.
+     */
+    bool isInSegment(Numeric rawValue, uint32_t i) const
+    {
+        uint32_t last = _numPoints - 2;
+        return i <= last && (i == 0 || _rawValues[i] < rawValue) && (i == last || rawValue <= _rawValues[i + 1]);
+    }
+
+    /**
+     * Returns the size of a binary calibration table with the given number of calibration points.
+     */
+    static uint32_t tableSize(uint32_t numPoints, bool withCoefficients)
+    {
+        uint32_t values = 2 * numPoints + (withCoefficients ? coefficientCount(numPoints) : 0);
+        return sizeof(CalibratorTableHeader) + values * sizeof(Numeric);
+    }
+
+    /**
+     * Checks the header of a binary calibration table.
+     */
+    static bool checkHeader(const CalibratorTableHeader &header)
+    {
+        if (header.magic != CALIBRATOR_TABLE_MAGIC || header.version != CALIBRATOR_TABLE_VERSION || header.numericType != numericType())
+            return false;
+
+        // Stored coefficients must belong to the interpolation of this calibrator
+        if ((header.flags & CALIBRATOR_TABLE_COEFFICIENTS) && (header.flags >> CALIBRATOR_TABLE_INTERPOLATION_SHIFT) != Interpolation::id)
+            return false;
+
+        // At least two points and no overflow of the table size
+        return header.numPoints > 1 && header.numPoints <= (UINT32_MAX - sizeof(CalibratorTableHeader)) / ((2 + Interpolation::coefficients) * sizeof(Numeric));
+    }
+
+    /**
+     * Takes over the table of a calibrator whose storage has just been moved into this one and leaves it without a table.
+     */
+    void take(Calibrator &other)
+    {
+        _rawValues = other._rawValues;
+        _calibrationValues = other._calibrationValues;
+        _numPoints = other._numPoints;
+        _coefficients = _storage.relocate(other._coefficients, other._storage);
+        _searchData = _storage.relocate(other._searchData, other._storage);
+        _integrals = _storage.relocate(other._integrals, other._storage);
+        _extrema = _storage.relocate(other._extrema, other._storage);
+        _points = other._points;
+        _limitOutput = other._limitOutput;
+
+        other.clearTable();
+        other._points = nullptr;
+    }
+
+    /**
+     * Leaves the calibrator without a calibration table, so that 'calibrate()' returns the raw values. Does not release '_points'.
+     */
+    void clearTable()
+    {
+        _rawValues = nullptr;
+        _calibrationValues = nullptr;
+        _numPoints = 0;
+        _coefficients = nullptr;
+        _searchData = nullptr;
+        _integrals = nullptr;
+        _extrema = nullptr;
+    }
+
+    /**
+     * Returns the number of coefficients of all segments.
+     */
+    static uint32_t coefficientCount(uint32_t numPoints)
+    {
+        return Interpolation::coefficients * (numPoints - 1);
+    }
+
+    /**
+     * Uses precalculated coefficients, e.g. from a binary calibration table, and prepares the search data.
+     */
+    bool attachCoefficients(const Numeric *coefficients)
+    {
+        _coefficients = nullptr;
+        _searchData = nullptr;
+        _integrals = nullptr;
+        _extrema = nullptr;
+
+        Numeric *data = nullptr;
+        uint32_t size = Search::size(_numPoints);
+        if (size > 0)
+        {
+            data = _storage.allocate(size);
+            if (data == nullptr)
+                return false;
+        }
+        else
+        {
+            _storage.release();
+        }
+
+        if (!Search::prepare(_rawValues, _numPoints, data))
+            return false;
+
+        _coefficients = coefficients;
+        _searchData = data;
+        return true;
+    }
+
+    /**
+     * Returns the identification of the numeric type as stored in a binary calibration table.
+     */
+    static uint8_t numericType()
+    {
+        return sizeof(Numeric) | (std::numeric_limits<Numeric>::is_integer ? 0 : 0x40) | (std::numeric_limits<Numeric>::is_signed ? 0x80 : 0);
+    }
+
+    /**
+     * Converts a calibrated value to the type of the output buffer.
+     * Integer outputs are rounded to the nearest integer and limited to the range of the output type; NaN gives 0.
+     */
+    template <typename Output>
+    static Output convertSample(Numeric value)
+    {
+        return convertSample<Output>(value, std::integral_constant<bool, std::is_integral<Output>::value>(), std::integral_constant<bool, std::numeric_limits<Numeric>::is_integer>());
+    }
+
+    // Floating point output
+    template <typename Output, typename IntegerValue>
+    static Output convertSample(Numeric value, std::false_type, IntegerValue)
+    {
+        return static_cast<Output>(value);
+    }
+
+    // Floating point value to integer output; the cast of a value outside the range of the output type would be undefined
+    template <typename Output>
+    static Output convertSample(Numeric value, std::true_type, std::false_type)
+    {
+        if (!(value == value))
+            return 0;
+        Numeric rounded = value < 0 ? value - Numeric(0.5) : value + Numeric(0.5);
+        if (rounded <= static_cast<Numeric>(std::numeric_limits<Output>::lowest()))
+            return std::numeric_limits<Output>::lowest();
+        if (rounded >= static_cast<Numeric>(std::numeric_limits<Output>::max()))
+            return std::numeric_limits<Output>::max();
+        return static_cast<Output>(rounded);
+    }
+
+    // Integer value to integer output
+    template <typename Output>
+    static Output convertSample(Numeric value, std::true_type, std::true_type)
+    {
+        if (value < static_cast<Numeric>(0))
+        {
+            if (!std::numeric_limits<Output>::is_signed || static_cast<intmax_t>(value) < static_cast<intmax_t>(std::numeric_limits<Output>::lowest()))
+                return std::numeric_limits<Output>::lowest();
+        }
+        else if (static_cast<uintmax_t>(value) > static_cast<uintmax_t>(std::numeric_limits<Output>::max()))
+        {
+            return std::numeric_limits<Output>::max();
+        }
+        return static_cast<Output>(value);
+    }
+
+    const Numeric *_rawValues;         // Known input values
+    const Numeric *_calibrationValues; // Known calibration values
+    uint32_t _numPoints;               // Number of calibration points
+    const Numeric *_coefficients;      // Arrays of the interpolation coefficients (e.g. gradients and y-intercepts)
+    const Numeric *_searchData;        // Data precalculated by the search policy
+    const Numeric *_integrals;         // Integrals from the first calibration point to every calibration point, if requested in 'begin()'
+    const Numeric *_extrema;           // Segment tree of the minima and maxima of the segments, if requested in 'begin()'
+    StorageBuffer _storage;            // Memory for the coefficients and the search data
+    Numeric *_points;                  // Memory allocated for a restored calibration table
+    bool _limitOutput;                 // Limit output to calibration range if 'true'
+};
+
+// Calibrator of a single unit that shares the master curve of its sensor type and only stores its own gain and offset
+// The calibrated value is 'gain * master.calibrate(rawValue) + offset', i.e. one multiply-add after the master curve
+template <typename CalibratorType>
+class TrimmedCalibrator
+{
+public:
+    typedef typename CalibratorType::NumericType Numeric;
+
+    /**
+     * Constructor for a trimmed calibrator
+     *
+     * @param master Initialized calibrator with the master curve. It must outlive the trimmed calibrator and may be shared by any number of units.
+     * @param gain Optional gain of the unit. Default is 1
+     * @param offset Optional offset of the unit. Default is 0
+     */
+    TrimmedCalibrator(const CalibratorType &master, Numeric gain = 1, Numeric offset = 0)
+    {
+        _master = &master;
+        _gain = gain;
+        _offset = offset;
+    }
+
+    /**
+     * This method sets the gain and offset of the unit, e.g. after a two-point calibration against the master curve.
+     *
+     * @param gain Gain of the unit.
+     * @param offset Offset of the unit.
+     */
+    void setTrim(Numeric gain, Numeric offset)
+    {
+        _gain = gain;
+        _offset = offset;
+    }
+
+    Numeric gain() const
+    {
+        return _gain;
+    }
+
+    Numeric offset() const
+    {
+        return _offset;
+    }
+
+    /**
+     * This method calibrates a raw value with the master curve and the trim of the unit.
+     *
+     * @param rawValue A raw numeric value to be calibrated.
+     * @return A numeric, calibrated value.
+     */
+    Numeric calibrate(Numeric rawValue) const
+    {
+        return _gain * _master->calibrate(rawValue) + _offset;
+    }
+
+    /**
+     * This method calibrates a block of samples with the master curve and then applies the trim to the whole block.
+     *
+     * @param input Array of raw samples to calibrate.
+     * @param output Array that receives the calibrated values. May be the same array as 'input' if it has the numeric type.
+     * @param count Number of samples in the arrays.
+     */
+    template <typename Sample>
+    void calibrateBlock(const Sample *input, Numeric *output, uint32_t count) const
+    {
+        _master->calibrateBlock(input, output, count);
+        for (uint32_t i = 0; i < count; i++)
+            output[i] = _gain * output[i] + _offset;
+    }
+
+private:
+    const CalibratorType *_master; // Shared master curve
+    Numeric _gain;                 // Gain of the unit
+    Numeric _offset;               // Offset of the unit
+};
+
+// Family of calibration curves measured at several values of a secondary parameter, e.g. LiPo discharge curves at 0, 25 and 45 °C
+// 'setParameter()' blends the two neighbouring curves point by point into a cached table and prepares it with 'begin()' in O(n),
+// so 'calibrate()' at the same or a slowly changing parameter costs the same as a single calibrator
+template <typename CalibratorType>
+class CalibratorFamily
+{
+public:
+    typedef typename CalibratorType::NumericType Numeric;
+
+    /**
+     * Constructor for a family of curves
+     *
+     * @param parameters Array of the secondary parameter of each curve (e.g. temperatures) in ascending order.
+     * @param rawValues Array of 'numCurves' rows of 'numPoints' raw values, one row per curve.
+     * @param calibrationValues Array of 'numCurves' rows of 'numPoints' calibrated values, one row per curve.
+     * @param numCurves Number of curves.
+     * @param numPoints Number of calibration points of every curve.
+     * @param limitOutputToCalibrationRange An optional boolean variable that indicates whether to constrain the calibrated values to the range of the calibration table. Default is 'false'. Only used by the default policy 'CalibratorLimitFlag'
+     */
+    CalibratorFamily(const Numeric *parameters, const Numeric *rawValues, const Numeric *calibrationValues, uint32_t numCurves, uint32_t numPoints, bool limitOutputToCalibrationRange = false)
+        : _blended(new Numeric[2 * numPoints]), _calibrator(_blended, _blended + numPoints, numPoints, limitOutputToCalibrationRange)
+    {
+        _parameters = parameters;
+        _rawValues = rawValues;
+        _calibrationValues = calibrationValues;
+        _numCurves = numCurves;
+        _numPoints = numPoints;
+        _parameter = 0;
+        _options = 0;
+        _checked = false;
+        _ready = false;
+    }
+
+    ~CalibratorFamily()
+    {
+        delete[] _blended;
+    }
+
+    // The blended table belongs to the family
+    CalibratorFamily(const CalibratorFamily &) = delete;
+    CalibratorFamily &operator=(const CalibratorFamily &) = delete;
+
+    /**
+     * This method checks the parameters of the curves and prepares the table of the first curve.
+     *
+     * @param options Optional options that are passed to 'begin()' of the calibrator with every blended table, e.g. 'CALIBRATOR_INTEGRALS'. Default is 0
+     * @return 'true' if successful, otherwise 'false'.
+     */
+    bool begin(uint8_t options = 0)
+    {
+        _checked = false;
+        _ready = false;
+        if (_numCurves == 0)
+            return false;
+        for (uint32_t k = 0; k + 1 < _numCurves; k++)
+        {
+            if (!(_parameters[k] < _parameters[k + 1]))
+                return false;
+        }
+
+        _options = options;
+        _checked = true;
+        return blend(_parameters[0]);
+    }
+
+    /**
+     * This method sets the secondary parameter and blends the table if it has changed.
+     * Parameters outside the range of the curves use the first or last curve, because extrapolated curves may no longer be monotone.
+     *
+     * @param parameter New value of the secondary parameter, e.g. the current temperature.
+     * @param tolerance Optional change of the parameter that is ignored, so that noise of a slowly changing parameter does not blend the table again. Default is 0
+     * @return 'true' if successful, 'false' if 'begin()' was not successful or the blended table is not usable.
+     */
+    bool setParameter(Numeric parameter, Numeric tolerance = 0)
+    {
+        if (!_checked)
+            return false;
+        // Compared after clamping, so that parameters beyond the curves do not blend the same table again
+        parameter = clampParameter(parameter);
+        if (_ready && parameter - _parameter <= tolerance && _parameter - parameter <= tolerance)
+            return true;
+        return blend(parameter);
+    }
+
+    /**
+     * Returns the parameter of the cached table.
+     */
+    Numeric parameter() const
+    {
+        return _parameter;
+    }
+
+    /**
+     * This method calibrates a raw value with the cached table of the current parameter.
+     *
+     * @param rawValue A raw numeric value to be calibrated.
+     * @return A numeric, calibrated value.
+     */
+    Numeric calibrate(Numeric rawValue) const
+    {
+        return _calibrator.calibrate(rawValue);
+    }
+
+    /**
+     * This method sets the secondary parameter and calibrates a raw value.
+     *
+     * @param rawValue A raw numeric value to be calibrated.
+     * @param parameter Value of the secondary parameter.
+     * @return A numeric, calibrated value.
+     */
+    Numeric calibrate(Numeric rawValue, Numeric parameter)
+    {
+        setParameter(parameter);
+        return _calibrator.calibrate(rawValue);
+    }
+
+    /**
+     * Returns the calibrator of the cached table, e.g. for 'calibrateBlock()'. It is valid until the parameter changes.
+     */
+    const CalibratorType &calibrator() const
+    {
+        return _calibrator;
+    }
+
+private:
+    /**
+     * Limits the parameter to the range of the curves; NaN uses the first curve.
+     */
+    Numeric clampParameter(Numeric parameter) const
+    {
+        if (!(parameter > _parameters[0]))
+            return _parameters[0];
+        if (parameter > _parameters[_numCurves - 1])
+            return _parameters[_numCurves - 1];
+        return parameter;
+    }
+
+    /**
+     * Blends the two curves around a parameter within their range point by point and prepares the calibrator, O(numPoints).
+     */
+    bool blend(Numeric parameter)
+    {
+        _ready = false;
+        uint32_t last = _numCurves - 1;
+        _parameter = parameter;
+
+        // Pair of curves around the parameter
+        uint32_t k = 0;
+        while (k + 1 < last && _parameters[k + 1] < parameter)
+            k++;
+        uint32_t next = k < last ? k + 1 : k;
+
+        const Numeric *raw0 = _rawValues + k * _numPoints;
+        const Numeric *raw1 = _rawValues + next * _numPoints;
+        const Numeric *cal0 = _calibrationValues + k * _numPoints;
+        const Numeric *cal1 = _calibrationValues + next * _numPoints;
+        Numeric *raw = _blended;
+        Numeric *cal = _blended + _numPoints;
+        if (next == k || parameter == _parameters[k])
+        {
+            memcpy(raw, raw0, _numPoints * sizeof(Numeric));
+            memcpy(cal, cal0, _numPoints * sizeof(Numeric));
+        }
+        else if (parameter == _parameters[next])
+        {
+            memcpy(raw, raw1, _numPoints * sizeof(Numeric));
+            memcpy(cal, cal1, _numPoints * sizeof(Numeric));
+        }
+        else
+        {
+            Numeric distance = parameter - _parameters[k];
+            Numeric width = _parameters[next] - _parameters[k];
+            for (uint32_t i = 0; i < _numPoints; i++)
+            {
+                raw[i] = raw0[i] + (raw1[i] - raw0[i]) * distance / width;
+                cal[i] = cal0[i] + (cal1[i] - cal0[i]) * distance / width;
+            }
+        }
+
+        _ready = _calibrator.begin(_options);
+        return _ready;
+    }
+
+    Numeric *_blended;                 // Raw values and calibration values of the cached table
+    CalibratorType _calibrator;        // Calibrator of the cached table
+    const Numeric *_parameters;        // Secondary parameter of every curve
+    const Numeric *_rawValues;         // Raw values of all curves
+    const Numeric *_calibrationValues; // Calibration values of all curves
+    uint32_t _numCurves;               // Number of curves
+    uint32_t _numPoints;               // Number of calibration points per curve
+    Numeric _parameter;                // Parameter of the cached table
+    uint8_t _options;                  // Options for 'begin()' of the calibrator
+    bool _checked;                     // 'true' if 'begin()' has checked the curves
+    bool _ready;                       // 'true' if the cached table is usable
+};
+
+// Calibrator with several outputs per calibration point on a shared raw axis, e.g. battery voltage -> state of charge, remaining runtime and charge current
+// The segment is searched once for all outputs; the slopes and y-intercepts of all outputs of a segment are stored next to each other, so the outputs are evaluated in one loop that the compiler can vectorize
+// Linear interpolation; the outputs are the same as those of 'Outputs' separate calibrators with the default interpolation
+template <typename Numeric, uint32_t Outputs, typename OutOfRange = CalibratorLimitFlag, typename Search = CalibratorAutoSearch, typename Storage = CalibratorHeapStorage,
+          typename = typename std::enable_if<std::numeric_limits<Numeric>::is_specialized && (Outputs > 0)>::type>
+class MultiCalibrator
+{
+public:
+    // Numeric type of the calibration values
+    typedef Numeric NumericType;
+
+    // Memory for the coefficients and the search data
+    typedef typename Storage::template Buffer<Numeric, 2 * Outputs + Search::valuesPerPoint, Search::extraValues> StorageBuffer;
+
     /**
      * Constructor for the calibrator
      *
      * @param rawValues Array of raw values to calibrate.
-     * @param calibrationValues Array of calibrated values that match the raw values.
-     * @param numPoints Number of calibration points in the array.
-     * @param limitOutputToCalibrationRange An optional boolean variable that indicates whether to constrain the calibrated values to the range of the calibration table. Default is 'false'
+     * @param calibrationValues Array of 'numPoints' rows with 'Outputs' calibrated values each, i.e. the outputs of a calibration point are next to each other.
+     * @param numPoints Number of calibration points in the arrays.
+     * @param limitOutputToCalibrationRange An optional boolean variable that indicates whether to constrain the calibrated values to the range of the calibration table. Default is 'false'. Only used by the default policy 'CalibratorLimitFlag'
      */
-    Calibrator(const Numeric *rawValues, const Numeric *calibrationValues, uint32_t numPoints, bool limitOutputToCalibrationRange = false)
+    MultiCalibrator(const Numeric *rawValues, const Numeric *calibrationValues, uint32_t numPoints, bool limitOutputToCalibrationRange = false)
     {
-        // Pass the references of the input data
         _rawValues = rawValues;
         _calibrationValues = calibrationValues;
         _limitOutput = limitOutputToCalibrationRange;
         _numPoints = numPoints;
+        _coefficients = nullptr;
+        _searchData = nullptr;
     }
 
+    MultiCalibrator(const MultiCalibrator &) = delete;
+    MultiCalibrator &operator=(const MultiCalibrator &) = delete;
+
     /**
-     * This method checks that the data passed is usable and creates a calibration curve
+     * This method checks that the data passed is usable and creates the calibration curves of all outputs
      *
      * @return 'true' if successful, otherwise 'false'.
      */
     bool begin()
     {
-        // Check if rawValues array is sorted in ascending order
+        _coefficients = nullptr;
+        _searchData = nullptr;
+        if (!calibratorCheckPoints(_rawValues, _numPoints))
+            return false;
+
+        Numeric *data = _storage.allocate(storageSize());
+        if (data == nullptr)
+            return false;
+
+        // The slopes and y-intercepts of all outputs of a segment are stored one after another
         for (uint32_t i = 0; i < _numPoints - 1; i++)
         {
-            if (_rawValues[i] > _rawValues[i + 1])
+            Numeric *m = data + i * 2 * Outputs;
+            Numeric *b = m + Outputs;
+            const Numeric *lower = _calibrationValues + i * Outputs;
+            const Numeric *upper = lower + Outputs;
+            for (uint32_t k = 0; k < Outputs; k++)
             {
-                // The rawValues array is not sorted in ascending order
-                return false;
+                m[k] = (upper[k] - lower[k]) / (_rawValues[i + 1] - _rawValues[i]);
+                b[k] = lower[k] - m[k] * _rawValues[i];
             }
         }
 
-        // Check if there are at least two calibration points
-        if (_numPoints <= 1)
+        uint32_t count = 2 * Outputs * (_numPoints - 1);
+        if (!Search::prepare(_rawValues, _numPoints, data + count))
             return false;
 
-        // Generate arrays for slopes and y-intercepts
-        _m = new Numeric[_numPoints - 1];
-        _b = new Numeric[_numPoints - 1];
+        _coefficients = data;
+        _searchData = data + count;
+        return true;
+    }
 
-        // Calculate calibration curve
-        for (uint32_t i = 0; i < _numPoints - 1; i++)
+    /**
+     * Returns the number of values that 'begin()' needs from the storage for the coefficients and the search data.
+     */
+    uint32_t storageSize() const
+    {
+        return _numPoints > 1 ? 2 * Outputs * (_numPoints - 1) + Search::size(_numPoints) : 0;
+    }
+
+    /**
+     * Returns the storage of the coefficients, e.g. to assign an external buffer before 'begin()'.
+     */
+    StorageBuffer &storage()
+    {
+        return _storage;
+    }
+
+    /**
+     * This method calibrates a raw value for all outputs with a single search.
+     *
+     * @param rawValue A raw numeric value to be calibrated.
+     * @param outputs Array that receives the 'Outputs' calibrated values. If 'begin()' was not successful, every output is the raw value.
+     */
+    void calibrate(Numeric rawValue, Numeric *outputs) const
+    {
+        if (_coefficients == nullptr)
         {
-            _m[i] = (_calibrationValues[i + 1] - _calibrationValues[i]) / (_rawValues[i + 1] - _rawValues[i]);
-            _b[i] = _calibrationValues[i] - _m[i] * _rawValues[i];
+            for (uint32_t k = 0; k < Outputs; k++)
+                outputs[k] = rawValue;
+            return;
         }
-
-        return true;
+        calibrateSegment(rawValue, Search::find(_rawValues, _numPoints, _searchData, rawValue), outputs);
     }
 
     /**
-     * This method calibrates a raw value against a calibration table.
+     * This method calibrates a raw value for a single output.
      *
      * @param rawValue A raw numeric value to be calibrated.
+     * @param output Index of the output.
      * @return A numeric, calibrated value.
      */
-    Numeric calibrate(Numeric rawValue)
+    Numeric calibrateOutput(Numeric rawValue, uint32_t output) const
     {
-        Numeric calibratedValue; // Variable für den korrigierten Wert
-
-        if (_m == nullptr || _b == nullptr)
+        if (_coefficients == nullptr)
             return rawValue;
 
-        // Ist der Wert außerhalb des Bereiches?
-        if (rawValue < _rawValues[0]) // Prüfe ob Rohwert kleiner als der erste Kalibrierpunkt ist
-        {
-            if (_limitOutput)
-                return _calibrationValues[0];
+        uint32_t i = Search::find(_rawValues, _numPoints, _searchData, rawValue);
+        const Numeric *m = _coefficients + i * 2 * Outputs;
+        Numeric calibratedValue = m[output] * rawValue + m[Outputs + output];
+        if (rawValue < _rawValues[0])
+            return OutOfRange::below(calibratedValue, _calibrationValues[output], _limitOutput);
+        if (rawValue > _rawValues[_numPoints - 1])
+            return OutOfRange::above(calibratedValue, _calibrationValues[(_numPoints - 1) * Outputs + output], _limitOutput);
+        return calibratedValue;
+    }
 
-            calibratedValue = _m[0] * rawValue + _b[0]; // Anwenden der Kalibrierfunktion
-            return calibratedValue;
-        }
-        else if (rawValue > _rawValues[_numPoints - 1]) // Prüfe ob Rohwert größer als der letzte Kalibrierpunkt ist
-        {
-            if (_limitOutput)
-                return _calibrationValues[_numPoints - 1];
+    /**
+     * This method calibrates a block of samples for all outputs.
+     *
+     * @param input Array of raw samples to calibrate.
+     * @param output Array of 'count' rows that receive the 'Outputs' calibrated values of each sample.
+     * @param count Number of samples.
+     */
+    template <typename Sample>
+    void calibrateBlock(const Sample *input, Numeric *output, uint32_t count) const
+    {
+        for (uint32_t n = 0; n < count; n++)
+            calibrate(static_cast<Numeric>(input[n]), output + n * Outputs);
+    }
 
-            calibratedValue = _m[_numPoints - 2] * rawValue + _b[_numPoints - 2]; // Anwenden der Kalibrierfunktion
-            return calibratedValue;
-        }
+    uint32_t numPoints() const
+    {
+        return _numPoints;
+    }
 
-        // Kalibrierfunktion
-        for (uint32_t i = 0; i < _numPoints - 1; i++) // Durchlaufe die gegebenen Kalibrierpunkte
+private:
+    /**
+     * Evaluates all outputs of segment i and applies the out-of-range policy.
+     */
+    void calibrateSegment(Numeric rawValue, uint32_t i, Numeric *outputs) const
+    {
+        const Numeric *m = _coefficients + i * 2 * Outputs;
+        const Numeric *b = m + Outputs;
+        for (uint32_t k = 0; k < Outputs; k++)
+            outputs[k] = m[k] * rawValue + b[k];
+
+        // Is the value outside the range?
+        bool below = rawValue < _rawValues[0];
+        bool above = rawValue > _rawValues[_numPoints - 1];
+        if (below)
         {
-            if (rawValue >= _rawValues[i] && rawValue <= _rawValues[i + 1]) // Prüfe ob Rohwert zwischen zwei Kalibrierpunkten liegt
-            {
-                calibratedValue = _m[i] * rawValue + _b[i]; // Anwenden der Kalibrierfunktion
-                return calibratedValue;
-            }
+            for (uint32_t k = 0; k < Outputs; k++)
+                outputs[k] = OutOfRange::below(outputs[k], _calibrationValues[k], _limitOutput);
+        }
+        else if (above)
+        {
+            const Numeric *last = _calibrationValues + (_numPoints - 1) * Outputs;
+            for (uint32_t k = 0; k < Outputs; k++)
+                outputs[k] = OutOfRange::above(outputs[k], last[k], _limitOutput);
         }
-
-        // Wurde keine Kalibrierung angewendet, wird der Rohwert zurückgegeben
-        return rawValue;
     }
 
-private:
     const Numeric *_rawValues;         // Known input values
-    const Numeric *_calibrationValues; // Known calibration values
+    const Numeric *_calibrationValues; // Known calibration values, 'Outputs' per calibration point
     uint32_t _numPoints;               // Number of calibration points
-    Numeric *_m;                       // Array for gradients
-    Numeric *_b;                       // Array for y-intercepts
+    const Numeric *_coefficients;      // Slopes and y-intercepts of all outputs per segment
+    const Numeric *_searchData;        // Data precalculated by the search policy
+    StorageBuffer _storage;            // Memory for the coefficients and the search data
     bool _limitOutput;                 // Limit output to calibration range if 'true'
 };
 
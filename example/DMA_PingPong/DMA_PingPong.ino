@@ -0,0 +1,79 @@
+/*
+ * Example of using the calibrator on a ping-pong (double) buffer as it is filled by an ADC with DMA
+ * The DMA transfer is simulated with 'analogRead()' so that the example runs on every board
+ * Author: Sebastian Balzer
+ * Date: 2026-10-16
+ */
+
+#include <calibrator.h>
+
+//** Calibrator input values (measurement)
+// Note 1: The input values must be sorted in ascending order
+// Note 2: The input and output values must have the same data type and the same length
+const float adcCodes[] = {0, 310, 1240, 2480, 3720, 4095}; // ADC codes
+
+//** Calibrator output values (calibration values)
+// Note: Output values must have the same length as input values
+const float millivolts[] = {0, 250, 1000, 2000, 3000, 3300}; // Voltage at the ADC input in mV
+
+//** Length of the arrays
+// The length must be greater than or equal to 2
+uint32_t valuesLen = 6;
+
+//** Initiate the Calibrator
+Calibrator<float> adcCalibrator(adcCodes, millivolts, valuesLen, true);
+
+//** Ping-pong buffer
+// The DMA fills one half while the other half is processed
+const uint32_t halfLen = 32;
+uint16_t dmaBuffer[2 * halfLen]; // Raw ADC codes written by the DMA
+uint16_t mvBuffer[2 * halfLen];  // Calibrated values in mV
+
+// Called by the DMA interrupt when one half of the buffer has been filled
+void halfTransferCallback(uint32_t half)
+{
+    uint16_t *raw = &dmaBuffer[half * halfLen];
+
+    // Calibrate the whole half-buffer into the matching half of the output buffer
+    adcCalibrator.calibrateBlock(raw, &mvBuffer[half * halfLen], halfLen);
+
+    // Alternatively overwrite the raw codes with the calibrated values in place
+    // adcCalibrator.calibrateBlock(raw, halfLen);
+}
+
+void setup()
+{
+    // Serial for the output of this example
+    Serial.begin(19200);
+
+    if (!adcCalibrator.begin())
+    {
+        Serial.println("Calibrator initialization failed!");
+        while (1)
+            ;
+    }
+    else
+    {
+        Serial.println("ADC code\tVoltage [mV]");
+    }
+}
+
+void loop()
+{
+    static uint32_t half = 0;
+
+    // Simulate the DMA transfer of one half-buffer
+    for (uint32_t i = 0; i < halfLen; i++)
+        dmaBuffer[half * halfLen + i] = analogRead(A0);
+
+    halfTransferCallback(half);
+
+    Serial.print(dmaBuffer[half * halfLen]);
+    Serial.print("\t\t");
+    Serial.println(mvBuffer[half * halfLen]);
+
+    // Swap the halves
+    half ^= 1;
+
+    delay(1000);
+}
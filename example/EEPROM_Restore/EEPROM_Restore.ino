@@ -0,0 +1,93 @@
+/*
+ * Example of saving a ready-to-use calibrator to the EEPROM and restoring it at the next boot without calling 'begin()'
+ * Author: Sebastian Balzer
+ * Date: 2026-10-16
+ */
+
+#include <EEPROM.h>
+#include <calibrator.h>
+
+//** Calibrator input values (measurement)
+// Note 1: The input values must be sorted in ascending order
+// Note 2: The input and output values must have the same data type and the same length
+const float voltages[] = {3300, 3750, 3800, 3880, 4100, 4200}; // Battery voltages in mV
+
+//** Calibrator output values (calibration values)
+const float capacities[] = {0, 10, 40, 65, 90, 100}; // Remaining capacity at voltage in %
+
+//** Length of the arrays
+uint32_t valuesLen = 6;
+
+//** Address of the saved calibrator in the EEPROM
+const uint32_t eepromAddress = 0;
+
+//** Initiate the Calibrator
+Calibrator<float> battCalibrator(voltages, capacities, valuesLen, true);
+
+// Storage callbacks for the EEPROM
+bool eepromWrite(uint32_t address, const uint8_t *data, uint32_t length, void *context)
+{
+    for (uint32_t i = 0; i < length; i++)
+        EEPROM.update(address + i, data[i]);
+    return true;
+}
+
+bool eepromRead(uint32_t address, uint8_t *data, uint32_t length, void *context)
+{
+    for (uint32_t i = 0; i < length; i++)
+        data[i] = EEPROM.read(address + i);
+    return true;
+}
+
+// Returns 'true' if the saved calibrator was made from the calibration points of this sketch
+// After the arrays above were changed and the sketch was flashed again, the EEPROM still holds a valid table of the old points
+bool matchesPoints(const Calibrator<float> &saved)
+{
+    return saved.numPoints() == valuesLen &&
+           memcmp(saved.rawValues(), voltages, sizeof(voltages)) == 0 &&
+           memcmp(saved.calibrationValues(), capacities, sizeof(capacities)) == 0;
+}
+
+void setup()
+{
+    // Serial for the output of this example
+    Serial.begin(19200);
+
+    // Try to restore the calibrator from the EEPROM. This fails on the first boot or if the data is corrupted (version or CRC mismatch)
+    // A saved table with more points than this sketch is refused before any memory is allocated for it
+    // The saved calibrator is only used if it matches the calibration points of this sketch
+    Calibrator<float> saved(nullptr, nullptr, 0, true);
+    if (saved.restore(eepromRead, nullptr, eepromAddress, valuesLen) && matchesPoints(saved))
+    {
+        battCalibrator = std::move(saved);
+        Serial.println("Calibrator restored from EEPROM");
+    }
+    else
+    {
+        // Calculate the calibration curve and save it for the next boot
+        if (!battCalibrator.begin() || !battCalibrator.save(eepromWrite, nullptr, eepromAddress))
+        {
+            Serial.println("Calibrator initialization failed!");
+            while (1)
+                ;
+        }
+        Serial.println("Calibrator saved to EEPROM");
+    }
+
+    Serial.println("Voltage [mV]\tRemaining capacity [%]");
+}
+
+void loop()
+{
+    // Get the battery voltage with the appropriate function! Here 'random()' is used for the universal example
+    float battVoltage = random(3200.0f, 4300.0f);
+
+    // Calibrate the battery voltage to the percentage of remaining capacity
+    float remainCap = battCalibrator.calibrate(battVoltage);
+
+    Serial.print(battVoltage, 2);
+    Serial.print("\t\t");
+    Serial.println(remainCap, 2);
+
+    delay(1000);
+}
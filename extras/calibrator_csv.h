@@ -0,0 +1,57 @@
+#ifndef calibrator_csv_h
+#define calibrator_csv_h
+
+// Host-side reader for calibration tables in CSV format
+// Each line contains a raw value and the matching calibrated value separated by a comma, semicolon or whitespace
+// Empty lines, lines starting with '#' and lines that do not start with a number (e.g. a header line) are skipped
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+/**
+ * Reads a calibration table from a CSV file.
+ *
+ * @param path Path of the CSV file.
+ * @param rawValues Vector that receives the raw values.
+ * @param calibrationValues Vector that receives the calibrated values.
+ * @return 'true' if the file was read and contains at least two points, otherwise 'false'.
+ */
+inline bool readCalibrationCsv(const char *path, std::vector<double> &rawValues, std::vector<double> &calibrationValues)
+{
+    FILE *file = fopen(path, "r");
+    if (file == nullptr)
+        return false;
+
+    rawValues.clear();
+    calibrationValues.clear();
+
+    char line[256];
+    while (fgets(line, sizeof(line), file) != nullptr)
+    {
+        if (line[0] == '#')
+            continue;
+
+        char *end;
+        double raw = strtod(line, &end);
+        if (end == line)
+            continue;
+
+        // Skip the separator
+        while (*end == ',' || *end == ';' || *end == ' ' || *end == '\t')
+            end++;
+
+        char *start = end;
+        double calibrated = strtod(start, &end);
+        if (end == start)
+            continue;
+
+        rawValues.push_back(raw);
+        calibrationValues.push_back(calibrated);
+    }
+
+    fclose(file);
+    return rawValues.size() >= 2;
+}
+
+#endif
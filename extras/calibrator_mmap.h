@@ -0,0 +1,139 @@
+#ifndef calibrator_mmap_h
+#define calibrator_mmap_h
+
+// Host-side (POSIX) support for binary calibration table files
+// The file is memory-mapped and used by the calibrator in place, so loading a table costs page faults instead of parsing and recalculating
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../calibrator.h"
+
+/**
+ * Storage callbacks for 'Calibrator::save()' and 'Calibrator::restore()' that use a file opened with 'fopen()' as byte storage.
+ * Pass the 'FILE *' as context.
+ */
+inline bool calibratorFileWrite(uint32_t address, const uint8_t *data, uint32_t length, void *context)
+{
+    FILE *file = static_cast<FILE *>(context);
+    return fseek(file, address, SEEK_SET) == 0 && fwrite(data, 1, length, file) == length;
+}
+
+inline bool calibratorFileRead(uint32_t address, uint8_t *data, uint32_t length, void *context)
+{
+    FILE *file = static_cast<FILE *>(context);
+    return fseek(file, address, SEEK_SET) == 0 && fread(data, 1, length, file) == length;
+}
+
+template <typename Numeric>
+class CalibratorTableFile
+{
+public:
+    CalibratorTableFile()
+    {
+        _map = nullptr;
+        _length = 0;
+    }
+
+    ~CalibratorTableFile()
+    {
+        close();
+    }
+
+    CalibratorTableFile(const CalibratorTableFile &) = delete;
+    CalibratorTableFile &operator=(const CalibratorTableFile &) = delete;
+
+    /**
+     * This method maps a binary calibration table file into memory and loads it into the calibrator.
+     *
+     * @param path Path of the table file.
+     * @param verifyChecksum Optional boolean to skip the CRC check, which reads every page of the file. Default is 'true'
+     * @return 'true' if successful, otherwise 'false'.
+     */
+    bool open(const char *path, bool verifyChecksum = true)
+    {
+        close();
+
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size <= 0 || (uint64_t)st.st_size > UINT32_MAX)
+        {
+            ::close(fd);
+            return false;
+        }
+
+        void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED)
+            return false;
+
+        _map = map;
+        _length = st.st_size;
+
+        if (!_calibrator.loadTable(_map, _length, verifyChecksum))
+        {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * This method unmaps the table file. The calibrator is left without a calibration table and returns the raw values.
+     */
+    void close()
+    {
+        _calibrator = Calibrator<Numeric>();
+        if (_map != nullptr)
+            munmap(_map, _length);
+        _map = nullptr;
+        _length = 0;
+    }
+
+    /**
+     * Returns the calibrator that uses the mapped table.
+     */
+    const Calibrator<Numeric> &calibrator() const
+    {
+        return _calibrator;
+    }
+
+    /**
+     * This method writes the calibration table of a calibrator to a binary table file.
+     *
+     * @param path Path of the table file.
+     * @param calibrator Calibrator whose 'begin()' was successful.
+     * @param withCoefficients Optional boolean to also store the slopes and y-intercepts. Default is 'true'
+     * @return 'true' if successful, otherwise 'false'.
+     */
+    static bool write(const char *path, const Calibrator<Numeric> &calibrator, bool withCoefficients = true)
+    {
+        uint32_t size = calibrator.tableSize(withCoefficients);
+        if (size == 0)
+            return false;
+
+        uint8_t *table = new uint8_t[size];
+        bool success = calibrator.storeTable(table, size, withCoefficients) == size;
+
+        FILE *file = success ? fopen(path, "wb") : nullptr;
+        success = file != nullptr && fwrite(table, 1, size, file) == size;
+        if (file != nullptr)
+            success = fclose(file) == 0 && success;
+
+        delete[] table;
+        return success;
+    }
+
+private:
+    Calibrator<Numeric> _calibrator; // Calibrator that uses the mapped table
+    void *_map;                      // Start of the mapped file
+    uint32_t _length;                // Length of the mapped file in bytes
+};
+
+#endif
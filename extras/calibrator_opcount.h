@@ -0,0 +1,121 @@
+#ifndef calibrator_opcount_h
+#define calibrator_opcount_h
+
+// Host-side instrumentation of the calibrator
+// 'CalibratorCountingNumeric<T>' behaves like the numeric type T and counts the arithmetic operations performed with it,
+// so that the cost of 'begin()' and 'calibrate()' can be compared between policies without running on the target MCU
+
+#include <stdint.h>
+#include <limits>
+#include <type_traits>
+
+// Number of operations performed with counting numeric values
+struct CalibratorOperationCounts
+{
+    uint64_t comparisons;     // <, >, <=, >=, ==, !=
+    uint64_t multiplications; // *
+    uint64_t additions;       // +, - (including negation)
+    uint64_t divisions;       // /
+    uint64_t reads;           // Copies of values, i.e. loads from the tables and passing of values; an upper bound of the memory reads
+
+    void reset()
+    {
+        comparisons = 0;
+        multiplications = 0;
+        additions = 0;
+        divisions = 0;
+        reads = 0;
+    }
+
+    uint64_t total() const
+    {
+        return comparisons + multiplications + additions + divisions + reads;
+    }
+};
+
+template <typename T>
+class CalibratorCountingNumeric
+{
+    static_assert(std::is_arithmetic<T>::value, "The counted type must be numeric");
+
+public:
+    // Operations of all values of this type since the last 'counts.reset()'
+    static CalibratorOperationCounts counts;
+
+    CalibratorCountingNumeric() : _value() {}
+
+    template <typename A, typename = typename std::enable_if<std::is_arithmetic<A>::value>::type>
+    CalibratorCountingNumeric(A value) : _value(static_cast<T>(value))
+    {
+    }
+
+    CalibratorCountingNumeric(const CalibratorCountingNumeric &other) : _value(other._value)
+    {
+        counts.reads++;
+    }
+
+    CalibratorCountingNumeric &operator=(const CalibratorCountingNumeric &other)
+    {
+        counts.reads++;
+        _value = other._value;
+        return *this;
+    }
+
+    template <typename A, typename = typename std::enable_if<std::is_arithmetic<A>::value>::type>
+    explicit operator A() const
+    {
+        return static_cast<A>(_value);
+    }
+
+    T value() const
+    {
+        return _value;
+    }
+
+    friend CalibratorCountingNumeric operator+(CalibratorCountingNumeric a, CalibratorCountingNumeric b) { return count(counts.additions, a._value + b._value); }
+    friend CalibratorCountingNumeric operator-(CalibratorCountingNumeric a, CalibratorCountingNumeric b) { return count(counts.additions, a._value - b._value); }
+    friend CalibratorCountingNumeric operator*(CalibratorCountingNumeric a, CalibratorCountingNumeric b) { return count(counts.multiplications, a._value * b._value); }
+    friend CalibratorCountingNumeric operator/(CalibratorCountingNumeric a, CalibratorCountingNumeric b) { return count(counts.divisions, a._value / b._value); }
+    friend CalibratorCountingNumeric operator-(CalibratorCountingNumeric a) { return count(counts.additions, -a._value); }
+
+    CalibratorCountingNumeric &operator+=(CalibratorCountingNumeric b) { return *this = *this + b; }
+    CalibratorCountingNumeric &operator-=(CalibratorCountingNumeric b) { return *this = *this - b; }
+    CalibratorCountingNumeric &operator*=(CalibratorCountingNumeric b) { return *this = *this * b; }
+    CalibratorCountingNumeric &operator/=(CalibratorCountingNumeric b) { return *this = *this / b; }
+
+    friend bool operator<(CalibratorCountingNumeric a, CalibratorCountingNumeric b) { return compare(a._value < b._value); }
+    friend bool operator>(CalibratorCountingNumeric a, CalibratorCountingNumeric b) { return compare(a._value > b._value); }
+    friend bool operator<=(CalibratorCountingNumeric a, CalibratorCountingNumeric b) { return compare(a._value <= b._value); }
+    friend bool operator>=(CalibratorCountingNumeric a, CalibratorCountingNumeric b) { return compare(a._value >= b._value); }
+    friend bool operator==(CalibratorCountingNumeric a, CalibratorCountingNumeric b) { return compare(a._value == b._value); }
+    friend bool operator!=(CalibratorCountingNumeric a, CalibratorCountingNumeric b) { return compare(a._value != b._value); }
+
+private:
+    static CalibratorCountingNumeric count(uint64_t &counter, T value)
+    {
+        counter++;
+        return CalibratorCountingNumeric(value);
+    }
+
+    static bool compare(bool result)
+    {
+        counts.comparisons++;
+        return result;
+    }
+
+    T _value;
+};
+
+template <typename T>
+CalibratorOperationCounts CalibratorCountingNumeric<T>::counts = {0, 0, 0, 0, 0};
+
+// The counting type has the limits of the counted type, which also makes it usable as numeric type of the calibrator
+namespace std
+{
+    template <typename T>
+    class numeric_limits<CalibratorCountingNumeric<T>> : public numeric_limits<T>
+    {
+    };
+}
+
+#endif
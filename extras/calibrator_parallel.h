@@ -0,0 +1,179 @@
+#ifndef calibrator_parallel_h
+#define calibrator_parallel_h
+
+// Host-side parallel batch calibration for large data sets (e.g. reprocessing of archived sensor data)
+// The input is split into chunks that the threads of a pool take one after another from a shared counter, so fast threads take over the work of slow ones
+// Each chunk is calibrated with 'calibrateBlock()'; build with '-pthread'
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../calibrator.h"
+
+#ifndef CALIBRATOR_PARALLEL_CHUNK
+#define CALIBRATOR_PARALLEL_CHUNK 65536 // Samples per chunk; large enough to hide the scheduling cost, small enough to balance the threads
+#endif
+
+class CalibratorThreadPool
+{
+public:
+    /**
+     * Starts the worker threads of the pool. The calling thread of 'calibrate()' works as well, so 'numThreads - 1' threads are started.
+     *
+     * @param numThreads Optional number of threads. Default is '0', which uses one thread per hardware thread of the host
+     */
+    explicit CalibratorThreadPool(unsigned numThreads = 0)
+    {
+        if (numThreads == 0)
+            numThreads = std::thread::hardware_concurrency();
+        if (numThreads == 0)
+            numThreads = 1;
+
+        _job = nullptr;
+        _count = 0;
+        _chunkSize = CALIBRATOR_PARALLEL_CHUNK;
+        _generation = 0;
+        _active = 0;
+        _stop = false;
+        for (unsigned i = 1; i < numThreads; i++)
+            _workers.emplace_back(&CalibratorThreadPool::run, this);
+    }
+
+    ~CalibratorThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _start.notify_all();
+        for (std::thread &worker : _workers)
+            worker.join();
+    }
+
+    CalibratorThreadPool(const CalibratorThreadPool &) = delete;
+    CalibratorThreadPool &operator=(const CalibratorThreadPool &) = delete;
+
+    /**
+     * @return The number of threads that calibrate, including the calling thread.
+     */
+    unsigned threads() const
+    {
+        return _workers.size() + 1;
+    }
+
+    /**
+     * This method calibrates an array of samples with all threads of the pool and returns when every sample is calibrated.
+     * The calibrator is only read, so one calibrator is shared by all threads. Only one call may run at a time.
+     *
+     * @param calibrator Initialized calibrator of any policy combination.
+     * @param input Array of raw values.
+     * @param output Array that receives the calibrated values, may be the input array.
+     * @param count Number of samples.
+     * @param chunkSize Optional number of samples that a thread calibrates at once. Default is 'CALIBRATOR_PARALLEL_CHUNK'
+     */
+    template <typename CalibratorType, typename Sample, typename Output>
+    void calibrate(const CalibratorType &calibrator, const Sample *input, Output *output, uint64_t count, uint32_t chunkSize = CALIBRATOR_PARALLEL_CHUNK)
+    {
+        if (count == 0)
+            return;
+
+        std::function<void(uint64_t, uint32_t)> job = [&](uint64_t first, uint32_t length)
+        {
+            calibrator.calibrateBlock(input + first, output + first, length);
+        };
+        execute(job, count, chunkSize > 0 ? chunkSize : 1);
+    }
+
+private:
+    // Hands a job to the workers, takes part in it and waits until all workers are finished
+    void execute(const std::function<void(uint64_t, uint32_t)> &job, uint64_t count, uint32_t chunkSize)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _job = &job;
+            _count = count;
+            _chunkSize = chunkSize;
+            _next = 0;
+            _active = _workers.size();
+            _generation++;
+        }
+        _start.notify_all();
+
+        work();
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _done.wait(lock, [this]() { return _active == 0; });
+        _job = nullptr;
+    }
+
+    // Takes chunks from the shared counter until the job is done
+    void work()
+    {
+        for (;;)
+        {
+            uint64_t first = _next.fetch_add(_chunkSize);
+            if (first >= _count)
+                return;
+            uint64_t remaining = _count - first;
+            (*_job)(first, remaining < _chunkSize ? static_cast<uint32_t>(remaining) : _chunkSize);
+        }
+    }
+
+    // Main loop of a worker thread
+    void run()
+    {
+        unsigned generation = 0;
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _start.wait(lock, [&]() { return _stop || _generation != generation; });
+                if (_stop)
+                    return;
+                generation = _generation;
+            }
+
+            work();
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (--_active == 0)
+                _done.notify_one();
+        }
+    }
+
+    std::vector<std::thread> _workers;
+    std::mutex _mutex;
+    std::condition_variable _start;
+    std::condition_variable _done;
+    const std::function<void(uint64_t, uint32_t)> *_job;
+    std::atomic<uint64_t> _next;
+    uint64_t _count;
+    uint32_t _chunkSize;
+    unsigned _generation;
+    unsigned _active;
+    bool _stop;
+};
+
+/**
+ * Calibrates an array of samples with a temporary thread pool.
+ * For repeated calls, e.g. chunk by chunk of a stream, keep a 'CalibratorThreadPool' instead, which starts its threads only once.
+ *
+ * @param calibrator Initialized calibrator of any policy combination.
+ * @param input Array of raw values.
+ * @param output Array that receives the calibrated values, may be the input array.
+ * @param count Number of samples.
+ * @param numThreads Optional number of threads. Default is '0', which uses one thread per hardware thread of the host
+ */
+template <typename CalibratorType, typename Sample, typename Output>
+void calibrateParallel(const CalibratorType &calibrator, const Sample *input, Output *output, uint64_t count, unsigned numThreads = 0)
+{
+    CalibratorThreadPool pool(numThreads);
+    pool.calibrate(calibrator, input, output, count);
+}
+
+#endif
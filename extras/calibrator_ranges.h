@@ -0,0 +1,224 @@
+#ifndef calibrator_ranges_h
+#define calibrator_ranges_h
+
+// Host-side lazy calibration of sample sequences
+// 'samples | calibrated(calibrator)' calibrates each sample when it is read, without an intermediate array
+// Every iterator keeps the segment of the last sample as hint for the next one, so slowly changing signals need no search
+// With C++20 the result is a view that composes with the standard views; with C++11 it is a range for range-based for loops and algorithms
+
+#include <stdint.h>
+#include <iterator>
+#include <utility>
+#if __cplusplus >= 202002L
+#include <ranges>
+#endif
+
+#include "../calibrator.h"
+
+template <typename CalibratorType, typename Iterator>
+class CalibratedIterator
+{
+public:
+    typedef typename CalibratorType::NumericType value_type;
+    typedef value_type reference;
+    typedef const value_type *pointer;
+    typedef std::input_iterator_tag iterator_category;
+#if __cplusplus >= 202002L
+    typedef std::iter_difference_t<Iterator> difference_type;
+    typedef typename std::conditional<std::forward_iterator<Iterator>, std::forward_iterator_tag, std::input_iterator_tag>::type iterator_concept;
+#else
+    typedef typename std::iterator_traits<Iterator>::difference_type difference_type;
+#endif
+
+    CalibratedIterator() : _calibrator(nullptr), _iterator(), _segment(0)
+    {
+    }
+
+    CalibratedIterator(const CalibratorType &calibrator, Iterator iterator) : _calibrator(&calibrator), _iterator(std::move(iterator)), _segment(0)
+    {
+    }
+
+    value_type operator*() const
+    {
+        return _calibrator->calibrate(static_cast<value_type>(*_iterator), _segment);
+    }
+
+    CalibratedIterator &operator++()
+    {
+        ++_iterator;
+        return *this;
+    }
+
+    CalibratedIterator operator++(int)
+    {
+        CalibratedIterator previous = *this;
+        ++_iterator;
+        return previous;
+    }
+
+    friend bool operator==(const CalibratedIterator &a, const CalibratedIterator &b)
+    {
+        return a._iterator == b._iterator;
+    }
+
+    friend bool operator!=(const CalibratedIterator &a, const CalibratedIterator &b)
+    {
+        return !(a._iterator == b._iterator);
+    }
+
+    /**
+     * Returns the iterator over the raw samples.
+     */
+    const Iterator &base() const
+    {
+        return _iterator;
+    }
+
+private:
+    const CalibratorType *_calibrator; // Calibrator of the samples
+    Iterator _iterator;                // Current raw sample
+    mutable uint32_t _segment;         // Segment of the last calibrated sample
+};
+
+#if __cplusplus >= 202002L
+
+// End of a calibrated view whose underlying range has a different end type (e.g. a counted or unbounded range)
+template <typename Sentinel>
+class CalibratedSentinel
+{
+public:
+    CalibratedSentinel() = default;
+
+    explicit CalibratedSentinel(Sentinel sentinel) : _sentinel(std::move(sentinel))
+    {
+    }
+
+    template <typename CalibratorType, typename Iterator>
+    friend bool operator==(const CalibratedIterator<CalibratorType, Iterator> &iterator, const CalibratedSentinel &sentinel)
+    {
+        return iterator.base() == sentinel._sentinel;
+    }
+
+private:
+    Sentinel _sentinel;
+};
+
+template <typename CalibratorType, std::ranges::view View>
+class CalibratedView : public std::ranges::view_interface<CalibratedView<CalibratorType, View>>
+{
+public:
+    CalibratedView() = default;
+
+    CalibratedView(const CalibratorType &calibrator, View view) : _calibrator(&calibrator), _view(std::move(view))
+    {
+    }
+
+    auto begin() const
+        requires std::ranges::range<const View>
+    {
+        return CalibratedIterator<CalibratorType, std::ranges::iterator_t<const View>>(*_calibrator, std::ranges::begin(_view));
+    }
+
+    auto end() const
+        requires std::ranges::range<const View>
+    {
+        if constexpr (std::ranges::common_range<const View>)
+            return CalibratedIterator<CalibratorType, std::ranges::iterator_t<const View>>(*_calibrator, std::ranges::end(_view));
+        else
+            return CalibratedSentinel<std::ranges::sentinel_t<const View>>(std::ranges::end(_view));
+    }
+
+    auto begin()
+    {
+        return CalibratedIterator<CalibratorType, std::ranges::iterator_t<View>>(*_calibrator, std::ranges::begin(_view));
+    }
+
+    auto end()
+    {
+        if constexpr (std::ranges::common_range<View>)
+            return CalibratedIterator<CalibratorType, std::ranges::iterator_t<View>>(*_calibrator, std::ranges::end(_view));
+        else
+            return CalibratedSentinel<std::ranges::sentinel_t<View>>(std::ranges::end(_view));
+    }
+
+    auto size() const
+        requires std::ranges::sized_range<const View>
+    {
+        return std::ranges::size(_view);
+    }
+
+private:
+    const CalibratorType *_calibrator = nullptr; // Calibrator of the samples
+    View _view;                                  // Raw samples
+};
+
+#else
+
+// Pair of calibrated iterators over a sequence of raw samples
+template <typename CalibratorType, typename Iterator>
+class CalibratedRange
+{
+public:
+    CalibratedRange(const CalibratorType &calibrator, Iterator first, Iterator last) : _begin(calibrator, first), _end(calibrator, last)
+    {
+    }
+
+    CalibratedIterator<CalibratorType, Iterator> begin() const
+    {
+        return _begin;
+    }
+
+    CalibratedIterator<CalibratorType, Iterator> end() const
+    {
+        return _end;
+    }
+
+private:
+    CalibratedIterator<CalibratorType, Iterator> _begin;
+    CalibratedIterator<CalibratorType, Iterator> _end;
+};
+
+#endif
+
+// Result of 'calibrated(calibrator)', applied to a range with 'operator|'
+template <typename CalibratorType>
+class CalibratedAdaptor
+{
+public:
+    explicit CalibratedAdaptor(const CalibratorType &calibrator) : _calibrator(&calibrator)
+    {
+    }
+
+#if __cplusplus >= 202002L
+    template <std::ranges::viewable_range Range>
+    friend auto operator|(Range &&range, const CalibratedAdaptor &adaptor)
+    {
+        return CalibratedView<CalibratorType, std::views::all_t<Range>>(*adaptor._calibrator, std::views::all(std::forward<Range>(range)));
+    }
+#else
+    // The range must outlive the calibrated range, as with any pair of iterators
+    template <typename Range>
+    friend auto operator|(Range &range, const CalibratedAdaptor &adaptor) -> CalibratedRange<CalibratorType, decltype(std::begin(range))>
+    {
+        return CalibratedRange<CalibratorType, decltype(std::begin(range))>(*adaptor._calibrator, std::begin(range), std::end(range));
+    }
+#endif
+
+private:
+    const CalibratorType *_calibrator;
+};
+
+/**
+ * Creates an adaptor that calibrates the samples of a range lazily: 'for (float value : samples | calibrated(calibrator))'.
+ * The calibrator must be initialized and outlive the calibrated range.
+ *
+ * @param calibrator Calibrator of any policy combination.
+ * @return Adaptor for 'operator|'.
+ */
+template <typename CalibratorType>
+CalibratedAdaptor<CalibratorType> calibrated(const CalibratorType &calibrator)
+{
+    return CalibratedAdaptor<CalibratorType>(calibrator);
+}
+
+#endif
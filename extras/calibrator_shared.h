@@ -0,0 +1,190 @@
+#ifndef calibrator_shared_h
+#define calibrator_shared_h
+
+// Host-side sharing of calibration tables between many calibrators, e.g. one calibrator per sensor with the same factory table
+// A registry keeps one immutable binary table (points and coefficients) per distinct content, found by its CRC-32
+// Handles use the shared table in place with 'loadTable()', so the memory grows with the number of distinct tables instead of the number of sensors
+
+#include <stdint.h>
+#include <string.h>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "../calibrator.h"
+
+// Immutable binary calibration table with coefficients, shared by handles
+template <typename CalibratorType>
+class CalibratorSharedTable
+{
+public:
+    explicit CalibratorSharedTable(std::vector<uint8_t> table) : _table(std::move(table))
+    {
+    }
+
+    const void *data() const
+    {
+        return _table.data();
+    }
+
+    uint32_t length() const
+    {
+        return _table.size();
+    }
+
+    /**
+     * Returns the CRC-32 of the table data from the header, which identifies the content.
+     */
+    uint32_t checksum() const
+    {
+        return reinterpret_cast<const CalibratorTableHeader *>(_table.data())->checksum;
+    }
+
+private:
+    std::vector<uint8_t> _table; // Header, points and coefficients; allocated with 'new', so aligned for every numeric type
+};
+
+// Lightweight calibrator that uses a shared table; copies share the table as well
+template <typename CalibratorType>
+class CalibratorHandle
+{
+public:
+    typedef typename CalibratorType::NumericType Numeric;
+    typedef std::shared_ptr<const CalibratorSharedTable<CalibratorType>> TablePointer;
+
+    /**
+     * Constructor for a handle
+     *
+     * @param table Shared table from 'CalibratorTableRegistry::acquire()'. A handle without table returns the raw values.
+     * @param limitOutputToCalibrationRange An optional boolean variable that indicates whether to constrain the calibrated values to the range of the calibration table. Default is 'false'. Only used by the default policy 'CalibratorLimitFlag'
+     */
+    explicit CalibratorHandle(TablePointer table = TablePointer(), bool limitOutputToCalibrationRange = false)
+        : _table(std::move(table)), _limitOutput(limitOutputToCalibrationRange), _calibrator(nullptr, nullptr, 0, limitOutputToCalibrationRange)
+    {
+        attach();
+    }
+
+    CalibratorHandle(const CalibratorHandle &other) : CalibratorHandle(other._table, other._limitOutput)
+    {
+    }
+
+    // The calibrator inside cannot be reassigned
+    CalibratorHandle &operator=(const CalibratorHandle &) = delete;
+
+    Numeric calibrate(Numeric rawValue) const
+    {
+        return _calibrator.calibrate(rawValue);
+    }
+
+    /**
+     * Returns the calibrator that uses the shared table, e.g. for 'calibrateBlock()'.
+     */
+    const CalibratorType &calibrator() const
+    {
+        return _calibrator;
+    }
+
+    const TablePointer &table() const
+    {
+        return _table;
+    }
+
+private:
+    // The table was checked by the registry, so the CRC is not verified again
+    void attach()
+    {
+        if (_table)
+            _calibrator.loadTable(_table->data(), _table->length(), false);
+    }
+
+    TablePointer _table;        // Keeps the shared table alive
+    bool _limitOutput;          // Limit output to calibration range if 'true'
+    CalibratorType _calibrator; // Calibrator that uses the shared table in place
+};
+
+template <typename CalibratorType>
+class CalibratorTableRegistry
+{
+public:
+    typedef typename CalibratorType::NumericType Numeric;
+    typedef std::shared_ptr<const CalibratorSharedTable<CalibratorType>> TablePointer;
+
+    /**
+     * This method returns the shared table for a set of calibration points; identical points give the same table.
+     *
+     * @param rawValues Array of raw values to calibrate.
+     * @param calibrationValues Array of calibrated values that match the raw values.
+     * @param numPoints Number of calibration points in the array.
+     * @return The shared table, or an empty pointer if the points are not usable.
+     */
+    TablePointer acquire(const Numeric *rawValues, const Numeric *calibrationValues, uint32_t numPoints)
+    {
+        CalibratorType calibrator(rawValues, calibrationValues, numPoints);
+        if (!calibrator.begin())
+            return TablePointer();
+        return share(calibrator);
+    }
+
+    /**
+     * This method returns the shared table for a binary calibration table, e.g. read from a file; identical tables give the same shared table.
+     *
+     * @param table Pointer to the table. Must be aligned for the numeric type.
+     * @param length Length of the table in bytes.
+     * @return The shared table, or an empty pointer if the table is not valid.
+     */
+    TablePointer acquire(const void *table, uint32_t length)
+    {
+        CalibratorType calibrator;
+        if (!calibrator.loadTable(table, length))
+            return TablePointer();
+        return share(calibrator);
+    }
+
+    /**
+     * Returns the number of distinct tables that are still used by handles.
+     */
+    size_t size()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto entry = _tables.begin(); entry != _tables.end();)
+            entry = entry->second.expired() ? _tables.erase(entry) : std::next(entry);
+        return _tables.size();
+    }
+
+private:
+    // Stores the table of an initialized calibrator with coefficients and looks it up by content
+    TablePointer share(const CalibratorType &calibrator)
+    {
+        std::vector<uint8_t> table(calibrator.tableSize());
+        if (table.empty() || calibrator.storeTable(table.data(), table.size()) != table.size())
+            return TablePointer();
+        uint32_t checksum = reinterpret_cast<const CalibratorTableHeader *>(table.data())->checksum;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto range = _tables.equal_range(checksum);
+        for (auto entry = range.first; entry != range.second;)
+        {
+            TablePointer shared = entry->second.lock();
+            if (!shared)
+            {
+                entry = _tables.erase(entry);
+                continue;
+            }
+
+            // Same CRC-32 does not guarantee the same content
+            if (shared->length() == table.size() && memcmp(shared->data(), table.data(), table.size()) == 0)
+                return shared;
+            ++entry;
+        }
+
+        TablePointer shared = std::make_shared<const CalibratorSharedTable<CalibratorType>>(std::move(table));
+        _tables.emplace(checksum, shared);
+        return shared;
+    }
+
+    std::mutex _mutex;
+    std::unordered_multimap<uint32_t, std::weak_ptr<const CalibratorSharedTable<CalibratorType>>> _tables; // Tables by CRC-32, released when the last handle is gone
+};
+
+#endif
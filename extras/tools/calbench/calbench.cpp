@@ -0,0 +1,164 @@
+/*
+ * Benchmark of the calibrator on the host
+ * Measures 'calibrate()', 'calibrateBlock()' and every search policy for the LiPo table of the examples, or for a table generated with calgen.
+ * The parallel batch calibration is measured with 1 to N threads to show the scaling on the host.
+ * With a generated table, the specialized function is checked against 'Calibrator::calibrate()' for identical results and benchmarked against it.
+ *
+ * Build: g++ -std=c++11 -O2 -pthread -o calbench extras/tools/calbench/calbench.cpp
+ *        g++ -std=c++11 -O2 -pthread -ffp-contract=off -DCALBENCH_TABLE=lipo -include lipo.h -o calbench extras/tools/calbench/calbench.cpp
+ * Note: '-ffp-contract=off' keeps the compiler from fusing 'm * x + b' differently in both functions, which would break the bit-exact comparison on targets with FMA
+ * Usage: calbench [samples] [threads]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+
+#include "../../../calibrator.h"
+#include "../../calibrator_parallel.h"
+
+#define CALBENCH_CONCAT(a, b) a##b
+#define CALBENCH_MEMBER(name, member) CALBENCH_CONCAT(name, member)
+
+#ifdef CALBENCH_TABLE
+typedef decltype(CALBENCH_TABLE(CALBENCH_MEMBER(CALBENCH_TABLE, _raw)[0])) Numeric;
+static const Numeric *rawValues = CALBENCH_MEMBER(CALBENCH_TABLE, _raw);
+static const Numeric *calibrationValues = CALBENCH_MEMBER(CALBENCH_TABLE, _cal);
+static const uint32_t numPoints = CALBENCH_MEMBER(CALBENCH_TABLE, _points);
+static const bool limitOutput = CALBENCH_MEMBER(CALBENCH_TABLE, _limit);
+#else
+typedef float Numeric;
+static const Numeric rawValues[] = {3300, 3750, 3800, 3880, 4100, 4200};
+static const Numeric calibrationValues[] = {0, 10, 40, 65, 90, 100};
+static const uint32_t numPoints = 6;
+static const bool limitOutput = true;
+#endif
+
+// Runs a benchmark and prints the time per sample
+template <typename Function>
+static void measure(const char *name, uint32_t samples, Function function)
+{
+    // Warm up and take the best of several runs
+    function();
+    double best = 0;
+    for (int run = 0; run < 5; run++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (run == 0 || seconds < best)
+            best = seconds;
+    }
+    printf("%-24s %8.3f ns/sample %10.1f MSamples/s\n", name, best * 1e9 / samples, samples / best / 1e6);
+}
+
+// Measures 'calibrate()' with a search policy
+template <typename Search>
+static void measureSearch(const char *name, const std::vector<Numeric> &input)
+{
+    Calibrator<Numeric, CalibratorLimitFlag, Search> calibrator(rawValues, calibrationValues, numPoints, limitOutput);
+    if (!calibrator.begin())
+    {
+        printf("%-24s not applicable\n", name);
+        return;
+    }
+
+    uint32_t samples = input.size();
+    volatile Numeric sink;
+    measure(name, samples, [&]() {
+        Numeric sum = 0;
+        for (uint32_t i = 0; i < samples; i++)
+            sum += calibrator.calibrate(input[i]);
+        sink = sum;
+    });
+    (void)sink;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t samples = argc > 1 ? strtoul(argv[1], nullptr, 0) : 1000000;
+    unsigned maxThreads = argc > 2 ? strtoul(argv[2], nullptr, 0) : std::thread::hardware_concurrency();
+    if (maxThreads == 0)
+        maxThreads = 1;
+
+    Calibrator<Numeric> calibrator(rawValues, calibrationValues, numPoints, limitOutput);
+    if (!calibrator.begin())
+    {
+        fprintf(stderr, "calbench: calibrator initialization failed\n");
+        return 1;
+    }
+
+    // Random raw values that cover the calibration range and a margin on both sides
+    Numeric low = rawValues[0];
+    Numeric high = rawValues[numPoints - 1];
+    Numeric margin = (high - low) / 10;
+    std::vector<Numeric> input(samples);
+    std::vector<Numeric> output(samples);
+    srand(1);
+    for (uint32_t i = 0; i < samples; i++)
+        input[i] = static_cast<Numeric>(low - margin + (high - low + 2 * margin) * (double)rand() / RAND_MAX);
+
+    printf("%u points, %u samples\n", numPoints, samples);
+
+    volatile Numeric sink;
+    measure("calibrate()", samples, [&]() {
+        Numeric sum = 0;
+        for (uint32_t i = 0; i < samples; i++)
+            sum += calibrator.calibrate(input[i]);
+        sink = sum;
+    });
+    measure("calibrateBlock()", samples, [&]() {
+        calibrator.calibrateBlock(input.data(), output.data(), samples);
+    });
+
+    measureSearch<CalibratorLinearSearch>("linear search", input);
+    measureSearch<CalibratorBinarySearch>("binary search", input);
+    measureSearch<CalibratorCountSearch>("count search", input);
+    measureSearch<CalibratorUniformSearch>("uniform search", input);
+    measureSearch<CalibratorEytzingerSearch>("Eytzinger search", input);
+    measureSearch<CalibratorFixedDepthSearch>("fixed-depth search", input);
+
+    // Thread scaling of the parallel batch calibration: 1, 2, 4, ... threads and the maximum
+    for (unsigned threads = 1;; threads = threads * 2 < maxThreads ? threads * 2 : maxThreads)
+    {
+        CalibratorThreadPool pool(threads);
+        char name[32];
+        snprintf(name, sizeof(name), "parallel, %u threads", threads);
+        measure(name, samples, [&]() {
+            pool.calibrate(calibrator, input.data(), output.data(), samples);
+        });
+        if (threads == maxThreads)
+            break;
+    }
+
+#ifdef CALBENCH_TABLE
+    // The generated function must give the same results as the calibrator
+    for (uint32_t i = 0; i < samples; i++)
+    {
+        if (CALBENCH_TABLE(input[i]) != calibrator.calibrate(input[i]))
+        {
+            fprintf(stderr, "calbench: generated function differs at raw value %.9g\n", (double)input[i]);
+            return 1;
+        }
+    }
+    for (uint32_t i = 0; i < numPoints; i++)
+    {
+        if (CALBENCH_TABLE(rawValues[i]) != calibrator.calibrate(rawValues[i]))
+        {
+            fprintf(stderr, "calbench: generated function differs at calibration point %u\n", i);
+            return 1;
+        }
+    }
+
+    measure("generated", samples, [&]() {
+        Numeric sum = 0;
+        for (uint32_t i = 0; i < samples; i++)
+            sum += CALBENCH_TABLE(input[i]);
+        sink = sum;
+    });
+#endif
+
+    (void)sink;
+    return 0;
+}
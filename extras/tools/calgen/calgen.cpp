@@ -0,0 +1,188 @@
+/*
+ * Table-to-code generator
+ * Reads a calibration table from a CSV file and emits a header with a specialized calibrate function for this fixed table.
+ * The function selects slope and y-intercept with a comparison tree of literal constants (no memory loads for the breakpoints) and gives the same results as 'Calibrator::calibrate()'.
+ *
+ * Build: g++ -std=c++11 -O2 -o calgen extras/tools/calgen/calgen.cpp
+ * Usage: calgen [--type float|double|int16|int32|int64|uint16|uint32] [--name NAME] [--limit] table.csv [output.h]
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "../../../calibrator.h"
+#include "../../calibrator_csv.h"
+
+// Formats a constant of the numeric type as C++ literal that is read back without rounding
+template <typename Numeric>
+static std::string literal(Numeric value)
+{
+    char text[64];
+    if (std::is_floating_point<Numeric>::value)
+    {
+        snprintf(text, sizeof(text), sizeof(Numeric) == sizeof(float) ? "%.9g" : "%.17g", (double)value);
+        if (strpbrk(text, ".en") == nullptr)
+            strcat(text, ".0");
+        if (sizeof(Numeric) == sizeof(float))
+            strcat(text, "f");
+    }
+    else if (std::is_signed<Numeric>::value)
+    {
+        snprintf(text, sizeof(text), "%lld", (long long)value);
+    }
+    else
+    {
+        snprintf(text, sizeof(text), "%lluU", (unsigned long long)value);
+    }
+    return text;
+}
+
+// Emits a comparison tree over the upper breakpoints that selects one of the coefficients of the segments 'low' to 'high'
+template <typename Numeric>
+static std::string selectTree(const Numeric *rawValues, const Numeric *coefficients, uint32_t low, uint32_t high)
+{
+    if (low == high)
+        return literal(coefficients[low]);
+
+    uint32_t mid = low + (high - low) / 2;
+    return "(x <= " + literal(rawValues[mid + 1]) + " ? " + selectTree(rawValues, coefficients, low, mid) + " : " + selectTree(rawValues, coefficients, mid + 1, high) + ")";
+}
+
+template <typename Numeric>
+static std::string array(const Numeric *values, uint32_t count)
+{
+    std::string text;
+    for (uint32_t i = 0; i < count; i++)
+        text += (i ? ", " : "") + literal(values[i]);
+    return text;
+}
+
+template <typename Numeric>
+static bool generate(FILE *out, const std::vector<double> &raw, const std::vector<double> &cal, const char *type, const std::string &name, bool limit, const char *source)
+{
+    // Calculate the curve with the library itself, so that the coefficients are identical
+    uint32_t numPoints = raw.size();
+    std::vector<Numeric> rawValues(raw.begin(), raw.end());
+    std::vector<Numeric> calibrationValues(cal.begin(), cal.end());
+    Calibrator<Numeric> calibrator(rawValues.data(), calibrationValues.data(), numPoints, limit);
+    if (!calibrator.begin())
+    {
+        fprintf(stderr, "calgen: the raw values must be sorted in ascending order\n");
+        return false;
+    }
+
+    // Read the slopes and y-intercepts from the binary table of the calibrator
+    std::vector<Numeric> table(calibrator.tableSize() / sizeof(Numeric) + 1);
+    calibrator.storeTable(table.data(), table.size() * sizeof(Numeric));
+    const Numeric *m = reinterpret_cast<const Numeric *>(reinterpret_cast<const uint8_t *>(table.data()) + sizeof(CalibratorTableHeader)) + 2 * numPoints;
+    const Numeric *b = m + (numPoints - 1);
+
+    fprintf(out, "// Generated by calgen from '%s' (%u points) - do not edit\n", source, numPoints);
+    fprintf(out, "#ifndef %s_h\n#define %s_h\n\n", name.c_str(), name.c_str());
+    fprintf(out, "#include <stdint.h>\n\n");
+    fprintf(out, "// Calibration points\n");
+    fprintf(out, "static const %s %s_raw[%u] = {%s};\n", type, name.c_str(), numPoints, array(rawValues.data(), numPoints).c_str());
+    fprintf(out, "static const %s %s_cal[%u] = {%s};\n", type, name.c_str(), numPoints, array(calibrationValues.data(), numPoints).c_str());
+    fprintf(out, "static const uint32_t %s_points = %u;\n", name.c_str(), numPoints);
+    fprintf(out, "static const bool %s_limit = %s;\n\n", name.c_str(), limit ? "true" : "false");
+    fprintf(out, "// Calibrates a raw value with the fixed table, gives the same results as 'Calibrator<%s>::calibrate()'\n", type);
+    fprintf(out, "static inline %s %s(%s x)\n{\n", type, name.c_str(), type);
+    fprintf(out, "    const %s m = %s;\n", type, selectTree(rawValues.data(), m, 0, numPoints - 2).c_str());
+    fprintf(out, "    const %s b = %s;\n", type, selectTree(rawValues.data(), b, 0, numPoints - 2).c_str());
+    if (limit)
+    {
+        fprintf(out, "    return x < %s ? %s : (x > %s ? %s : m * x + b);\n",
+                literal(rawValues[0]).c_str(), literal(calibrationValues[0]).c_str(),
+                literal(rawValues[numPoints - 1]).c_str(), literal(calibrationValues[numPoints - 1]).c_str());
+    }
+    else
+    {
+        fprintf(out, "    return m * x + b;\n");
+    }
+    fprintf(out, "}\n\n#endif\n");
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    const char *type = "float";
+    const char *input = nullptr;
+    const char *output = nullptr;
+    std::string name;
+    bool limit = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--type") == 0 && i + 1 < argc)
+            type = argv[++i];
+        else if (strcmp(argv[i], "--name") == 0 && i + 1 < argc)
+            name = argv[++i];
+        else if (strcmp(argv[i], "--limit") == 0)
+            limit = true;
+        else if (input == nullptr)
+            input = argv[i];
+        else
+            output = argv[i];
+    }
+
+    if (input == nullptr)
+    {
+        fprintf(stderr, "Usage: calgen [--type float|double|int16|int32|int64|uint16|uint32] [--name NAME] [--limit] table.csv [output.h]\n");
+        return 2;
+    }
+
+    // Derive the function name from the file name of the table
+    if (name.empty())
+    {
+        const char *base = strrchr(input, '/');
+        name = base ? base + 1 : input;
+        name = name.substr(0, name.find('.'));
+        for (size_t i = 0; i < name.size(); i++)
+        {
+            if (!isalnum((unsigned char)name[i]))
+                name[i] = '_';
+        }
+    }
+
+    std::vector<double> raw, cal;
+    if (!readCalibrationCsv(input, raw, cal))
+    {
+        fprintf(stderr, "calgen: cannot read a table with at least two points from '%s'\n", input);
+        return 1;
+    }
+
+    FILE *out = output ? fopen(output, "w") : stdout;
+    if (out == nullptr)
+    {
+        fprintf(stderr, "calgen: cannot write '%s'\n", output);
+        return 1;
+    }
+
+    bool success;
+    if (strcmp(type, "float") == 0)
+        success = generate<float>(out, raw, cal, "float", name, limit, input);
+    else if (strcmp(type, "double") == 0)
+        success = generate<double>(out, raw, cal, "double", name, limit, input);
+    else if (strcmp(type, "int16") == 0)
+        success = generate<int16_t>(out, raw, cal, "int16_t", name, limit, input);
+    else if (strcmp(type, "int32") == 0)
+        success = generate<int32_t>(out, raw, cal, "int32_t", name, limit, input);
+    else if (strcmp(type, "int64") == 0)
+        success = generate<int64_t>(out, raw, cal, "int64_t", name, limit, input);
+    else if (strcmp(type, "uint16") == 0)
+        success = generate<uint16_t>(out, raw, cal, "uint16_t", name, limit, input);
+    else if (strcmp(type, "uint32") == 0)
+        success = generate<uint32_t>(out, raw, cal, "uint32_t", name, limit, input);
+    else
+    {
+        fprintf(stderr, "calgen: unknown type '%s'\n", type);
+        success = false;
+    }
+
+    if (output)
+        fclose(out);
+    return success ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+/*
+ * Operation count report of the calibrator
+ * Counts the comparisons, multiplications, additions, divisions and reads of 'begin()' and 'calibrate()' for every search and interpolation policy.
+ * The counts do not depend on the host, so they can be used to estimate the cost on small MCUs (AVR, Cortex-M0) and to catch algorithmic regressions.
+ * The constant-time searches (count, Eytzinger, fixed-depth) must take the same number of arithmetic operations and comparisons for every raw value; the tool fails if they do not.
+ * Reads are reported but not checked, because they also count copies that the compiler keeps in registers.
+ *
+ * Build: g++ -std=c++11 -O2 -o calopcount extras/tools/calopcount/calopcount.cpp
+ * Usage: calopcount [table.csv]
+ */
+
+#include <stdio.h>
+#include <vector>
+
+#include "../../../calibrator.h"
+#include "../../calibrator_csv.h"
+#include "../../calibrator_opcount.h"
+
+typedef CalibratorCountingNumeric<float> Numeric;
+
+// Minimum, average and maximum of one counter per call
+struct Statistics
+{
+    uint64_t min;
+    uint64_t max;
+    uint64_t sum;
+
+    void add(uint64_t value, bool first)
+    {
+        min = first || value < min ? value : min;
+        max = first || value > max ? value : max;
+        sum = first ? value : sum + value;
+    }
+};
+
+// Prints the operation counts of a policy combination, returns 'false' if a constant count was expected and not found
+template <typename Search, typename Interpolation>
+static bool report(const char *name, const std::vector<Numeric> &rawValues, const std::vector<Numeric> &calibrationValues, bool constant)
+{
+    uint32_t numPoints = rawValues.size();
+    Calibrator<Numeric, CalibratorClamp, Search, Interpolation> calibrator(rawValues.data(), calibrationValues.data(), numPoints);
+
+    Numeric::counts.reset();
+    if (!calibrator.begin())
+    {
+        printf("%-28s not applicable\n", name);
+        return true;
+    }
+    CalibratorOperationCounts begin = Numeric::counts;
+
+    // Raw values on a fine grid over the calibration range and a margin on both sides, including every breakpoint
+    std::vector<Numeric> inputs(rawValues);
+    float low = rawValues[0].value();
+    float high = rawValues[numPoints - 1].value();
+    float margin = (high - low) / 10;
+    for (uint32_t i = 0; i <= 1000; i++)
+        inputs.push_back(low - margin + (high - low + 2 * margin) * i / 1000);
+
+    Statistics stats[5];
+    for (uint32_t i = 0; i < inputs.size(); i++)
+    {
+        Numeric::counts.reset();
+        calibrator.calibrate(inputs[i]);
+        const CalibratorOperationCounts &c = Numeric::counts;
+        uint64_t values[5] = {c.comparisons, c.multiplications, c.additions, c.divisions, c.reads};
+        for (uint8_t k = 0; k < 5; k++)
+            stats[k].add(values[k], i == 0);
+    }
+
+    printf("%-28s begin: %6llu cmp %6llu mul %6llu add %6llu div %6llu read\n", name,
+           (unsigned long long)begin.comparisons, (unsigned long long)begin.multiplications, (unsigned long long)begin.additions,
+           (unsigned long long)begin.divisions, (unsigned long long)begin.reads);
+    printf("%-28s calibrate (min/avg/max):", "");
+    const char *labels[5] = {"cmp", "mul", "add", "div", "read"};
+    bool isConstant = true;
+    for (uint8_t k = 0; k < 5; k++)
+    {
+        printf(" %llu/%.1f/%llu %s", (unsigned long long)stats[k].min, (double)stats[k].sum / inputs.size(), (unsigned long long)stats[k].max, labels[k]);
+        isConstant = isConstant && (stats[k].min == stats[k].max || k == 4);
+    }
+    printf("\n");
+
+    if (constant && !isConstant)
+    {
+        fprintf(stderr, "calopcount: %s does not have a constant operation count\n", name);
+        return false;
+    }
+    return true;
+}
+
+template <typename Interpolation>
+static bool reportAll(const char *interpolation, const std::vector<Numeric> &rawValues, const std::vector<Numeric> &calibrationValues)
+{
+    printf("%s interpolation\n", interpolation);
+    bool success = true;
+    success &= report<CalibratorLinearSearch, Interpolation>("  linear search", rawValues, calibrationValues, false);
+    success &= report<CalibratorBinarySearch, Interpolation>("  binary search", rawValues, calibrationValues, false);
+    success &= report<CalibratorCountSearch, Interpolation>("  count search", rawValues, calibrationValues, true);
+    success &= report<CalibratorUniformSearch, Interpolation>("  uniform search", rawValues, calibrationValues, false);
+    success &= report<CalibratorEytzingerSearch, Interpolation>("  Eytzinger search", rawValues, calibrationValues, true);
+    success &= report<CalibratorFixedDepthSearch, Interpolation>("  fixed-depth search", rawValues, calibrationValues, true);
+    return success;
+}
+
+int main(int argc, char **argv)
+{
+    // LiPo table of the examples, or a table from a CSV file
+    std::vector<double> raw = {3300, 3750, 3800, 3880, 4100, 4200};
+    std::vector<double> cal = {0, 10, 40, 65, 90, 100};
+    if (argc > 1 && !readCalibrationCsv(argv[1], raw, cal))
+    {
+        fprintf(stderr, "calopcount: cannot read a table with at least two points from '%s'\n", argv[1]);
+        return 1;
+    }
+
+    std::vector<Numeric> rawValues(raw.begin(), raw.end());
+    std::vector<Numeric> calibrationValues(cal.begin(), cal.end());
+    printf("%u points\n", (unsigned)rawValues.size());
+
+    bool success = true;
+    success &= reportAll<CalibratorStep>("Step", rawValues, calibrationValues);
+    success &= reportAll<CalibratorLinear>("Linear", rawValues, calibrationValues);
+    success &= reportAll<CalibratorCubic>("Cubic", rawValues, calibrationValues);
+    return success ? 0 : 1;
+}
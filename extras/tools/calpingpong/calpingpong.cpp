@@ -0,0 +1,146 @@
+/*
+ * Simulated DMA ping-pong buffer on the host
+ * A producer thread fills the two halves of a buffer with ADC codes like a DMA controller, and the consumer calibrates each full half with 'calibrateBlock()'
+ * while the producer fills the other half. Every calibrated half is checked against 'calibrate()' and the narrowing rules of integer outputs
+ * (rounded to the nearest value, limited to the range of the output type). The tool fails if a sample differs or a half is overwritten before it is calibrated.
+ *
+ * Build: g++ -std=c++11 -O2 -pthread -o calpingpong extras/tools/calpingpong/calpingpong.cpp
+ * Usage: calpingpong [blocks]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <atomic>
+#include <thread>
+
+#include "../../../calibrator.h"
+
+// ADC codes -> mV with an offset below 0 mV and a gain that exceeds the range of 'int8_t' and, extrapolated, of 'uint16_t'
+static const float adcCodes[] = {0, 310, 1240, 2480, 3720, 4095};
+static const float millivolts[] = {-80, 250, 1000, 2000, 3000, 3600};
+
+static const uint32_t halfLength = 256;
+
+// Ping-pong buffer shared by the producer and the consumer
+struct PingPong
+{
+    uint16_t codes[2 * halfLength];
+    std::atomic<bool> full[2];
+    std::atomic<uint32_t> sequence[2]; // Number of the block in each half, checked after the calibration
+};
+
+// Expected value of an integer output, calculated in double independently of the calibrator
+template <typename Output>
+static Output expected(float value)
+{
+    if (isnan(value))
+        return 0;
+    double rounded = value < 0 ? value - 0.5 : value + 0.5;
+    if (rounded <= (double)std::numeric_limits<Output>::lowest())
+        return std::numeric_limits<Output>::lowest();
+    if (rounded >= (double)std::numeric_limits<Output>::max())
+        return std::numeric_limits<Output>::max();
+    return (Output)rounded;
+}
+
+// Code of sample i of a block; every 16th code is far outside the table so that the outputs saturate
+static uint16_t code(uint32_t block, uint32_t i)
+{
+    uint32_t x = (block * halfLength + i) * 2654435761u;
+    return (i % 16 == 0) ? (uint16_t)(60000 + x % 5000) : (uint16_t)(x % 4200);
+}
+
+// Calibrates one full half into all output types and counts the differences
+template <typename CalibratorType>
+static uint32_t check(const CalibratorType &calibrator, const uint16_t *codes)
+{
+    float calibrated[halfLength];
+    uint16_t unsigned16[halfLength];
+    int8_t signed8[halfLength];
+    float inPlace[halfLength];
+
+    calibrator.calibrateBlock(codes, calibrated, halfLength);
+    calibrator.calibrateBlock(codes, unsigned16, halfLength);
+    calibrator.calibrateBlock(codes, signed8, halfLength);
+    for (uint32_t i = 0; i < halfLength; i++)
+        inPlace[i] = codes[i];
+    calibrator.calibrateBlock(inPlace, halfLength);
+
+    uint32_t errors = 0;
+    for (uint32_t i = 0; i < halfLength; i++)
+    {
+        float value = calibrator.calibrate((float)codes[i]);
+        errors += calibrated[i] != value || inPlace[i] != value;
+        errors += unsigned16[i] != expected<uint16_t>(value);
+        errors += signed8[i] != expected<int8_t>(value);
+    }
+    return errors;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t blocks = argc > 1 ? strtoul(argv[1], nullptr, 0) : 10000;
+
+    Calibrator<float, CalibratorExtrapolate> calibrator(adcCodes, millivolts, 6);
+    if (!calibrator.begin())
+    {
+        fprintf(stderr, "calpingpong: the calibrator cannot be initialized\n");
+        return 1;
+    }
+
+    static PingPong buffer;
+    for (uint8_t half = 0; half < 2; half++)
+    {
+        buffer.full[half] = false;
+        buffer.sequence[half] = 0;
+    }
+
+    // Producer: fills the halves alternately like a circular DMA transfer and waits while the consumer still works on a half
+    std::thread producer([&]()
+    {
+        for (uint32_t block = 0; block < blocks; block++)
+        {
+            uint32_t half = block & 1;
+            while (buffer.full[half].load(std::memory_order_acquire))
+                std::this_thread::yield();
+            for (uint32_t i = 0; i < halfLength; i++)
+                buffer.codes[half * halfLength + i] = code(block, i);
+            buffer.sequence[half].store(block, std::memory_order_relaxed);
+            buffer.full[half].store(true, std::memory_order_release);
+        }
+    });
+
+    // Consumer: half-transfer and transfer-complete callbacks
+    uint32_t errors = 0;
+    uint32_t lost = 0;
+    uint32_t saturated = 0;
+    for (uint32_t block = 0; block < blocks; block++)
+    {
+        uint32_t half = block & 1;
+        while (!buffer.full[half].load(std::memory_order_acquire))
+            std::this_thread::yield();
+
+        const uint16_t *codes = &buffer.codes[half * halfLength];
+        lost += buffer.sequence[half].load(std::memory_order_relaxed) != block;
+        errors += check(calibrator, codes);
+        for (uint32_t i = 0; i < halfLength; i++)
+        {
+            float value = calibrator.calibrate((float)codes[i]);
+            saturated += value < 0 || value > 65535;
+        }
+        lost += buffer.sequence[half].load(std::memory_order_relaxed) != block;
+
+        buffer.full[half].store(false, std::memory_order_release);
+    }
+    producer.join();
+
+    // NaN is converted to 0, not to an undefined value
+    float nan[2] = {NAN, -NAN};
+    uint16_t nanOutput[2] = {1, 1};
+    calibrator.calibrateBlock(nan, nanOutput, 2);
+    errors += nanOutput[0] != 0 || nanOutput[1] != 0;
+
+    printf("calpingpong: %u blocks of %u samples, %u saturated samples, %u errors, %u overwritten halves\n", blocks, halfLength, saturated, errors, lost);
+    return errors == 0 && lost == 0 ? 0 : 1;
+}
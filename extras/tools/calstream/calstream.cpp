@@ -0,0 +1,251 @@
+/*
+ * Streaming calibration of raw sensor logs
+ * Reads raw values from a text file (one value per line) or a binary file, calibrates them with a table and writes the calibrated values in the same order.
+ * The log is processed in chunks: the next chunk is read while the current chunk is calibrated by a thread pool and written, so the memory use does not depend on the file size.
+ * The table is a CSV file (raw value, calibrated value per line) or a binary table file written by 'storeTable()' or 'CalibratorTableFile::write()'.
+ *
+ * Build: g++ -std=c++11 -O2 -pthread -o calstream extras/tools/calstream/calstream.cpp
+ * Usage: calstream [--type float|double] [--limit] [--input text|int16|uint16|int32|uint32|float|double] [--output text|binary]
+ *                  [--threads N] [--chunk N] table.csv|table.bin [input] [output]
+ * Input and output default to stdin and stdout; the throughput is reported on stderr.
+ * '--limit' applies to CSV tables; a binary table file does not store the limit flag.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <future>
+#include <vector>
+
+#include "../../../calibrator.h"
+#include "../../calibrator_csv.h"
+#include "../../calibrator_mmap.h"
+#include "../../calibrator_parallel.h"
+
+// Options of the command line
+struct Options
+{
+    const char *type;
+    const char *input;
+    const char *output;
+    const char *table;
+    const char *inputPath;
+    const char *outputPath;
+    bool limit;
+    unsigned threads;
+    uint32_t chunk;
+};
+
+// Reads up to 'count' binary samples, returns the number of samples read
+template <typename Sample>
+static uint32_t readBinary(FILE *file, Sample *buffer, uint32_t count)
+{
+    return fread(buffer, sizeof(Sample), count, file);
+}
+
+// Reads up to 'count' samples from text lines, lines that do not start with a number (e.g. a header line) are skipped
+static uint32_t readText(FILE *file, double *buffer, uint32_t count)
+{
+    char line[256];
+    uint32_t n = 0;
+    while (n < count && fgets(line, sizeof(line), file) != nullptr)
+    {
+        char *end;
+        double value = strtod(line, &end);
+        if (end != line)
+            buffer[n++] = value;
+    }
+    return n;
+}
+
+// Writes the calibrated values as text lines or in native binary format
+template <typename Numeric>
+static bool writeValues(FILE *file, const Numeric *values, uint32_t count, bool text)
+{
+    if (!text)
+        return fwrite(values, sizeof(Numeric), count, file) == count;
+
+    char buffer[65536];
+    uint32_t length = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (length > sizeof(buffer) - 32)
+        {
+            if (fwrite(buffer, 1, length, file) != length)
+                return false;
+            length = 0;
+        }
+        length += snprintf(buffer + length, sizeof(buffer) - length, sizeof(Numeric) == sizeof(float) ? "%.9g\n" : "%.17g\n", (double)values[i]);
+    }
+    return fwrite(buffer, 1, length, file) == length;
+}
+
+// Streams the input through the calibrator with two input buffers: one is read while the other is calibrated and written
+template <typename Numeric, typename Sample>
+static bool stream(const Calibrator<Numeric> &calibrator, FILE *in, FILE *out, const Options &options, uint32_t (*read)(FILE *, Sample *, uint32_t))
+{
+    std::vector<Sample> buffers[2] = {std::vector<Sample>(options.chunk), std::vector<Sample>(options.chunk)};
+    std::vector<Numeric> output(options.chunk);
+    CalibratorThreadPool pool(options.threads);
+    bool text = strcmp(options.output, "text") == 0;
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t total = 0;
+    uint8_t current = 0;
+    uint32_t count = read(in, buffers[current].data(), options.chunk);
+    while (count > 0)
+    {
+        std::future<uint32_t> next = std::async(std::launch::async, read, in, buffers[1 - current].data(), options.chunk);
+        pool.calibrate(calibrator, buffers[current].data(), output.data(), count);
+        bool written = writeValues(out, output.data(), count, text);
+        uint32_t nextCount = next.get();
+        if (!written)
+        {
+            fprintf(stderr, "calstream: cannot write the output\n");
+            return false;
+        }
+
+        total += count;
+        count = nextCount;
+        current = 1 - current;
+    }
+    if (ferror(in))
+    {
+        fprintf(stderr, "calstream: cannot read the input\n");
+        return false;
+    }
+    if (fflush(out) != 0)
+    {
+        fprintf(stderr, "calstream: cannot write the output\n");
+        return false;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    fprintf(stderr, "calstream: %llu samples in %.3f s, %.1f MSamples/s with %u threads\n",
+            (unsigned long long)total, seconds, seconds > 0 ? total / seconds / 1e6 : 0.0, pool.threads());
+    return true;
+}
+
+// Dispatches on the input format
+template <typename Numeric>
+static bool process(const Calibrator<Numeric> &calibrator, const Options &options, FILE *in, FILE *out)
+{
+    if (strcmp(options.input, "text") == 0)
+        return stream<Numeric, double>(calibrator, in, out, options, readText);
+    if (strcmp(options.input, "int16") == 0)
+        return stream<Numeric, int16_t>(calibrator, in, out, options, readBinary<int16_t>);
+    if (strcmp(options.input, "uint16") == 0)
+        return stream<Numeric, uint16_t>(calibrator, in, out, options, readBinary<uint16_t>);
+    if (strcmp(options.input, "int32") == 0)
+        return stream<Numeric, int32_t>(calibrator, in, out, options, readBinary<int32_t>);
+    if (strcmp(options.input, "uint32") == 0)
+        return stream<Numeric, uint32_t>(calibrator, in, out, options, readBinary<uint32_t>);
+    if (strcmp(options.input, "float") == 0)
+        return stream<Numeric, float>(calibrator, in, out, options, readBinary<float>);
+    if (strcmp(options.input, "double") == 0)
+        return stream<Numeric, double>(calibrator, in, out, options, readBinary<double>);
+
+    fprintf(stderr, "calstream: unknown input format '%s'\n", options.input);
+    return false;
+}
+
+// Loads the table: a CSV table is calibrated with 'begin()', a binary table file is mapped and used in place
+template <typename Numeric>
+static bool run(const Options &options, FILE *in, FILE *out)
+{
+    size_t length = strlen(options.table);
+    if (length > 4 && strcmp(options.table + length - 4, ".csv") == 0)
+    {
+        std::vector<double> raw, cal;
+        if (!readCalibrationCsv(options.table, raw, cal))
+        {
+            fprintf(stderr, "calstream: cannot read a table with at least two points from '%s'\n", options.table);
+            return false;
+        }
+
+        std::vector<Numeric> rawValues(raw.begin(), raw.end());
+        std::vector<Numeric> calibrationValues(cal.begin(), cal.end());
+        Calibrator<Numeric> calibrator(rawValues.data(), calibrationValues.data(), rawValues.size(), options.limit);
+        if (!calibrator.begin())
+        {
+            fprintf(stderr, "calstream: the raw values of '%s' are not sorted in ascending order\n", options.table);
+            return false;
+        }
+        return process(calibrator, options, in, out);
+    }
+
+    CalibratorTableFile<Numeric> tableFile;
+    if (!tableFile.open(options.table))
+    {
+        fprintf(stderr, "calstream: '%s' is not a valid %s table file\n", options.table, options.type);
+        return false;
+    }
+    return process(tableFile.calibrator(), options, in, out);
+}
+
+int main(int argc, char **argv)
+{
+    Options options = {"float", "text", "text", nullptr, nullptr, nullptr, false, 0, 1 << 20};
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--type") == 0 && i + 1 < argc)
+            options.type = argv[++i];
+        else if (strcmp(argv[i], "--input") == 0 && i + 1 < argc)
+            options.input = argv[++i];
+        else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+            options.output = argv[++i];
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            options.threads = strtoul(argv[++i], nullptr, 0);
+        else if (strcmp(argv[i], "--chunk") == 0 && i + 1 < argc)
+            options.chunk = strtoul(argv[++i], nullptr, 0);
+        else if (strcmp(argv[i], "--limit") == 0)
+            options.limit = true;
+        else if (options.table == nullptr)
+            options.table = argv[i];
+        else if (options.inputPath == nullptr)
+            options.inputPath = argv[i];
+        else
+            options.outputPath = argv[i];
+    }
+
+    if (options.table == nullptr || options.chunk == 0 || (strcmp(options.output, "text") != 0 && strcmp(options.output, "binary") != 0))
+    {
+        fprintf(stderr, "Usage: calstream [--type float|double] [--limit] [--input text|int16|uint16|int32|uint32|float|double] [--output text|binary]\n"
+                        "                 [--threads N] [--chunk N] table.csv|table.bin [input] [output]\n");
+        return 2;
+    }
+
+    bool binaryInput = strcmp(options.input, "text") != 0;
+    FILE *in = options.inputPath ? fopen(options.inputPath, binaryInput ? "rb" : "r") : stdin;
+    if (in == nullptr)
+    {
+        fprintf(stderr, "calstream: cannot read '%s'\n", options.inputPath);
+        return 1;
+    }
+    bool binaryOutput = strcmp(options.output, "binary") == 0;
+    FILE *out = options.outputPath ? fopen(options.outputPath, binaryOutput ? "wb" : "w") : stdout;
+    if (out == nullptr)
+    {
+        fprintf(stderr, "calstream: cannot write '%s'\n", options.outputPath);
+        return 1;
+    }
+
+    bool success;
+    if (strcmp(options.type, "float") == 0)
+        success = run<float>(options, in, out);
+    else if (strcmp(options.type, "double") == 0)
+        success = run<double>(options, in, out);
+    else
+    {
+        fprintf(stderr, "calstream: unknown type '%s'\n", options.type);
+        success = false;
+    }
+
+    if (options.inputPath)
+        fclose(in);
+    if (options.outputPath)
+        success = fclose(out) == 0 && success;
+    return success ? 0 : 1;
+}